@@ -0,0 +1,97 @@
+#include "BatchConverter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool HasStepExtension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".stp" || ext == ".step";
+}
+
+} // namespace
+
+std::vector<std::string> CollectStepFiles(const std::string& source) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (fs::is_directory(source, ec)) {
+        for (const fs::directory_entry& entry : fs::directory_iterator(source, ec)) {
+            if (entry.is_regular_file(ec) && HasStepExtension(entry.path())) {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::ifstream list(source);
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) files.push_back(line);
+    }
+    return files;
+}
+
+std::string OutputPathFor(const std::string& stepFile, const std::string& outputDir) {
+    fs::path output(stepFile);
+    output.replace_extension(".h5");
+    if (!outputDir.empty()) {
+        output = fs::path(outputDir) / output.filename();
+    }
+    return output.string();
+}
+
+size_t RunBatch(const std::vector<std::string>& stepFiles, const std::string& outputDir,
+                const ConvertOptions& options, unsigned workers) {
+    if (!outputDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(outputDir, ec);
+    }
+    workers = std::max(1u, std::min<unsigned>(workers, static_cast<unsigned>(stepFiles.size())));
+
+    // Shared schema and application setup must happen before the workers start
+    InitializeConverter();
+
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> failures(0);
+    std::mutex logMutex;
+    const auto start = std::chrono::steady_clock::now();
+
+    auto work = [&]() {
+        for (size_t i = next++; i < stepFiles.size(); i = next++) {
+            const std::string& stepFile = stepFiles[i];
+            const std::string hdf5File = OutputPathFor(stepFile, outputDir);
+            const bool ok = ConvertStepFile(stepFile, hdf5File, options);
+            if (!ok) ++failures;
+
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << (ok ? "OK   " : "FAIL ") << stepFile << " -> " << hdf5File << "\n";
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < workers; ++w) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Converted " << stepFiles.size() - failures << "/" << stepFiles.size() << " files in "
+              << seconds << " s with " << workers << " workers\n";
+    return failures;
+}
@@ -0,0 +1,20 @@
+#ifndef BATCHCONVERTER_735B9A5F_1169_464C_B33E_57FA49151479
+#define BATCHCONVERTER_735B9A5F_1169_464C_B33E_57FA49151479
+
+#include "StepToH5Converter.h"
+
+#include <string>
+#include <vector>
+
+// Expand a directory (*.stp / *.step) or a text file listing one path per line.
+std::vector<std::string> CollectStepFiles(const std::string& source);
+
+// Output path for stepFile: same stem with an .h5 extension, placed in
+// outputDir when given, next to the input otherwise.
+std::string OutputPathFor(const std::string& stepFile, const std::string& outputDir);
+
+// Convert every file on a pool of workers. Returns the number of failures.
+size_t RunBatch(const std::vector<std::string>& stepFiles, const std::string& outputDir,
+                const ConvertOptions& options, unsigned workers);
+
+#endif /* BATCHCONVERTER_735B9A5F_1169_464C_B33E_57FA49151479 */
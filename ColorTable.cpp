@@ -0,0 +1,81 @@
+#include "ColorTable.h"
+
+#include <Quantity_ColorRGBA.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+
+#include "H5Columns.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+uint8_t ToByte(double value) {
+    return static_cast<uint8_t>(std::lround(std::min(1.0, std::max(0.0, value)) * 255.0));
+}
+
+class Palette {
+public:
+    explicit Palette(std::vector<uint8_t>& rgba) : myRgba(rgba) {}
+
+    uint16_t Index(const Quantity_ColorRGBA& color) {
+        Standard_Real r = 0.0, g = 0.0, b = 0.0;
+        color.GetRGB().Values(r, g, b, Quantity_TOC_sRGB);
+        const uint8_t bytes[4] = {ToByte(r), ToByte(g), ToByte(b), ToByte(color.Alpha())};
+        const uint32_t key = uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 |
+                             uint32_t(bytes[3]) << 24;
+
+        auto found = myIndex.find(key);
+        if (found != myIndex.end()) return found->second;
+        const size_t index = myRgba.size() / 4;
+        if (index >= ColorTable::NoColor) {
+            if (!myFull) std::cerr << "Color palette full, further colors are dropped\n";
+            myFull = true;
+            return ColorTable::NoColor;
+        }
+        myRgba.insert(myRgba.end(), bytes, bytes + 4);
+        myIndex.emplace(key, static_cast<uint16_t>(index));
+        return static_cast<uint16_t>(index);
+    }
+
+private:
+    std::vector<uint8_t>& myRgba;
+    std::unordered_map<uint32_t, uint16_t> myIndex;
+    bool myFull = false;
+};
+
+} // namespace
+
+ColorTable BuildColorTable(const LabelTable& labels) {
+    ColorTable table;
+    table.surface.assign(labels.Size(), ColorTable::NoColor);
+    table.curve.assign(labels.Size(), ColorTable::NoColor);
+
+    Palette palette(table.palette);
+    Quantity_ColorRGBA color;
+    for (size_t row = 0; row < labels.Size(); ++row) {
+        const TDF_Label& label = labels.label[row];
+        uint16_t generic = ColorTable::NoColor;
+        if (XCAFDoc_ColorTool::GetColor(label, XCAFDoc_ColorGen, color)) {
+            generic = palette.Index(color);
+        }
+        table.surface[row] = XCAFDoc_ColorTool::GetColor(label, XCAFDoc_ColorSurf, color) ? palette.Index(color) : generic;
+        table.curve[row] = XCAFDoc_ColorTool::GetColor(label, XCAFDoc_ColorCurv, color) ? palette.Index(color) : generic;
+    }
+    return table;
+}
+
+void WriteColorTable(H5::Group& group, const ColorTable& table, const H5WriterSettings& settings) {
+    WriteColumn(group, "ColorPalette", table.palette, H5::PredType::STD_U8LE, H5::PredType::NATIVE_UINT8, settings, 4);
+    WriteColumn(group, "ColorSurface", table.surface, H5::PredType::STD_U16LE, H5::PredType::NATIVE_UINT16, settings);
+    WriteColumn(group, "ColorVertex", table.curve, H5::PredType::STD_U16LE, H5::PredType::NATIVE_UINT16, settings);
+
+    // Rows without a color hold this index
+    H5::DataSet surface = group.openDataSet("ColorSurface");
+    const uint16_t noColor = ColorTable::NoColor;
+    surface.createAttribute("no_color", H5::PredType::STD_U16LE, H5::DataSpace()).write(H5::PredType::NATIVE_UINT16, &noColor);
+    H5::DataSet curve = group.openDataSet("ColorVertex");
+    curve.createAttribute("no_color", H5::PredType::STD_U16LE, H5::DataSpace()).write(H5::PredType::NATIVE_UINT16, &noColor);
+}
@@ -0,0 +1,30 @@
+#ifndef COLORTABLE_9C2E5B81_4A7F_4E36_B0D9_3F8A1C6E7D25
+#define COLORTABLE_9C2E5B81_4A7F_4E36_B0D9_3F8A1C6E7D25
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+
+#include <cstdint>
+#include <vector>
+
+// XCAF colors of every label row, including the face sub-shape labels under
+// parts, as indices into a deduplicated palette.
+struct ColorTable {
+    static constexpr uint16_t NoColor = 0xFFFF;
+
+    std::vector<uint8_t> palette;  // sRGB + alpha, 4 bytes per distinct color
+    std::vector<uint16_t> surface; // per label row: surface color, else generic color
+    std::vector<uint16_t> curve;   // per label row: curve color, else generic color
+
+    size_t PaletteSize() const { return palette.size() / 4; }
+};
+
+// Look up XCAFDoc_ColorTool surface, curve and generic colors of every row.
+ColorTable BuildColorTable(const LabelTable& labels);
+
+// Write the (P,4) "ColorPalette" dataset and the per-row "ColorSurface" and
+// "ColorVertex" (curve color) index datasets into group.
+void WriteColorTable(H5::Group& group, const ColorTable& table, const H5WriterSettings& settings);
+
+#endif /* COLORTABLE_9C2E5B81_4A7F_4E36_B0D9_3F8A1C6E7D25 */
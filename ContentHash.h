@@ -0,0 +1,82 @@
+#ifndef CONTENTHASH_7E2A9C14_5B3F_4D81_A6E0_93C4F1D8B25A
+#define CONTENTHASH_7E2A9C14_5B3F_4D81_A6E0_93C4F1D8B25A
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// Streaming 64-bit content hash (not cryptographic). Input is consumed eight
+// bytes at a time; the result does not depend on how the input is split
+// across Add() calls.
+class ContentHash {
+public:
+    explicit ContentHash(uint64_t seed = 0) : myState(seed ^ 0x9E3779B97F4A7C15ull) {}
+
+    void Add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        myLength += size;
+        if (myPending > 0) {
+            const size_t take = size < 8 - myPending ? size : 8 - myPending;
+            std::memcpy(myTail + myPending, bytes, take);
+            myPending += take;
+            bytes += take;
+            size -= take;
+            if (myPending < 8) return;
+            MixWord(myTail);
+            myPending = 0;
+        }
+        for (; size >= 8; bytes += 8, size -= 8) {
+            MixWord(bytes);
+        }
+        std::memcpy(myTail, bytes, size);
+        myPending = size;
+    }
+
+    void Add(std::string_view str) {
+        const uint64_t length = str.size();
+        AddValue(length);
+        Add(str.data(), str.size());
+    }
+
+    template <typename T>
+    void AddValue(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "hash trivially copyable values only");
+        Add(&value, sizeof(T));
+    }
+
+    uint64_t Value() const {
+        uint64_t word = 0;
+        std::memcpy(&word, myTail, myPending);
+        return Mix(myState ^ Mix(word ^ myLength));
+    }
+
+    // Order-dependent combination of two hashes.
+    static uint64_t Combine(uint64_t seed, uint64_t value) {
+        return Mix(seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2)));
+    }
+
+private:
+    static uint64_t Mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void MixWord(const unsigned char* bytes) {
+        uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        myState = (myState ^ Mix(word)) * 0x9FB21C651E98DF25ull;
+        myState ^= myState >> 29;
+    }
+
+    uint64_t myState;
+    uint64_t myLength = 0;
+    unsigned char myTail[8] = {};
+    size_t myPending = 0;
+};
+
+#endif /* CONTENTHASH_7E2A9C14_5B3F_4D81_A6E0_93C4F1D8B25A */
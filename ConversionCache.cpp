@@ -0,0 +1,147 @@
+#include "ConversionCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Serializes eviction between the batch workers of this process
+std::mutex theEvictMutex;
+
+// Sibling of path that no other thread writes to
+fs::path TemporaryPath(const fs::path& path) {
+    static std::atomic<uint64_t> counter{0};
+    const size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return fs::path(path.string() + ".tmp" + std::to_string(thread) + "-" + std::to_string(counter++));
+}
+
+// Hard-link from to a temporary next to `to` (copying across file systems)
+// and rename it into place, so readers never see a partial file.
+bool LinkOrCopy(const fs::path& from, const fs::path& to) {
+    std::error_code ec;
+    const fs::path temporary = TemporaryPath(to);
+    fs::create_hard_link(from, temporary, ec);
+    if (ec) {
+        ec.clear();
+        fs::copy_file(from, temporary, fs::copy_options::overwrite_existing, ec);
+    }
+    if (!ec) {
+        fs::rename(temporary, to, ec);
+    }
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+// "<16 hex digits>.<extension>" as EntryPath names entries of any kind;
+// temporaries carry a longer suffix and do not match
+bool IsEntryName(const fs::path& path) {
+    const std::string stem = path.stem().string();
+    return stem.size() == 16 && !path.extension().empty() &&
+           std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isxdigit(c); });
+}
+
+} // namespace
+
+ConversionCache::ConversionCache(const std::string& directory, uint64_t maxBytes, const std::string& extension)
+    : myDirectory(directory), myMaxBytes(maxBytes), myExtension(extension) {
+    std::error_code ec;
+    fs::create_directories(myDirectory, ec);
+}
+
+std::string ConversionCache::EntryPath(uint64_t key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return (fs::path(myDirectory) / (name + myExtension)).string();
+}
+
+bool ConversionCache::Fetch(uint64_t key, const std::string& target) const {
+    const fs::path entry = EntryPath(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(entry, ec)) return false;
+
+    // The modification time orders entries for eviction
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    return LinkOrCopy(entry, target);
+}
+
+bool ConversionCache::Store(uint64_t key, const std::string& source) const {
+    if (!LinkOrCopy(source, EntryPath(key))) return false;
+    if (myMaxBytes > 0) {
+        Evict();
+    }
+    return true;
+}
+
+void ConversionCache::Evict() const {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+
+    std::lock_guard<std::mutex> lock(theEvictMutex);
+    std::error_code ec;
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    for (const fs::directory_entry& file : fs::directory_iterator(myDirectory, ec)) {
+        // Caches sharing the directory share its size limit
+        if (!file.is_regular_file(ec) || !IsEntryName(file.path())) continue;
+        Entry entry{file.path(), file.last_write_time(ec), file.file_size(ec)};
+        if (ec) continue;
+        total += entry.size;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    for (const Entry& entry : entries) {
+        if (total <= myMaxBytes) break;
+        if (fs::remove(entry.path, ec)) {
+            total -= entry.size;
+        }
+    }
+}
+
+bool HashFileContents(const std::string& file, ContentHash& hash) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+
+    std::vector<char> buffer(1 << 20);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash.Add(buffer.data(), static_cast<size_t>(in.gcount()));
+    }
+    return in.eof();
+}
+
+void UnshareFile(const std::string& file, bool keepContents) {
+    std::error_code ec;
+    const uintmax_t links = fs::hard_link_count(file, ec);
+    if (ec || links <= 1) return;
+
+    if (!keepContents) {
+        fs::remove(file, ec);
+        return;
+    }
+    const fs::path temporary = TemporaryPath(file);
+    fs::copy_file(file, temporary, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        fs::rename(temporary, file, ec);
+    }
+    if (ec) {
+        fs::remove(temporary, ec);
+    }
+}
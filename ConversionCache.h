@@ -0,0 +1,44 @@
+#ifndef CONVERSIONCACHE_4C1E8A37_92D5_4B6F_8E03_D7A5B2F946C1
+#define CONVERSIONCACHE_4C1E8A37_92D5_4B6F_8E03_D7A5B2F946C1
+
+#include "ContentHash.h"
+
+#include <cstdint>
+#include <string>
+
+// Directory of finished .h5 files named by the hash of their STEP input and
+// converter options, or of other derived files with their own extension.
+// Entries are hard-linked into place when the cache and
+// the output share a file system and copied otherwise. The least recently
+// used entries are evicted once the directory grows past maxBytes.
+class ConversionCache {
+public:
+    // maxBytes 0 means unlimited. Entries of each kind end in their own
+    // extension, so caches of different kinds can share a directory; the
+    // limit then applies to all of their entries together.
+    ConversionCache(const std::string& directory, uint64_t maxBytes, const std::string& extension = ".h5");
+
+    // Place the entry for key at target. Returns false on a miss.
+    bool Fetch(uint64_t key, const std::string& target) const;
+
+    // Add source as the entry for key, then evict down to the size limit.
+    bool Store(uint64_t key, const std::string& source) const;
+
+private:
+    std::string EntryPath(uint64_t key) const;
+    void Evict() const;
+
+    std::string myDirectory;
+    uint64_t myMaxBytes;
+    std::string myExtension;
+};
+
+// Feed the bytes of file into hash. Returns false when it cannot be read.
+bool HashFileContents(const std::string& file, ContentHash& hash);
+
+// Give file its own inode before it is modified in place, so that a cache
+// entry hard-linked to it keeps its contents. With keepContents false the
+// link is simply removed.
+void UnshareFile(const std::string& file, bool keepContents);
+
+#endif /* CONVERSIONCACHE_4C1E8A37_92D5_4B6F_8E03_D7A5B2F946C1 */
@@ -0,0 +1,338 @@
+#include "ConversionDaemon.h"
+
+#include "BatchConverter.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Polling interval of the listening socket, the clients and the spool directory
+constexpr int thePollMs = 200;
+
+std::atomic<bool> theStopRequested(false);
+std::atomic<bool> theCancelRequested(false);
+
+// The first signal drains the queue, a second one cancels the running jobs
+void RequestStop(int) {
+    if (theStopRequested) {
+        theCancelRequested = true;
+    }
+    theStopRequested = true;
+}
+
+void InstallStopHandlers() {
+    theStopRequested = false;
+    theCancelRequested = false;
+    struct sigaction action {};
+    action.sa_handler = RequestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    // A client that hangs up must not take the daemon down with it
+    signal(SIGPIPE, SIG_IGN);
+}
+
+struct Job {
+    std::string stepFile;
+    std::string hdf5File;
+    Clock::time_point received;
+    std::function<void(bool ok, double milliseconds)> done;
+};
+
+// Blocking FIFO shared by the job sources and the workers.
+class JobQueue {
+public:
+    void Push(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myJobs.push_back(std::move(job));
+        }
+        myReady.notify_one();
+    }
+
+    // Next job, false once the queue is closed and drained.
+    bool Pop(Job& job) {
+        std::unique_lock<std::mutex> lock(myMutex);
+        myReady.wait(lock, [this] { return myClosed || !myJobs.empty(); });
+        if (myJobs.empty()) return false;
+        job = std::move(myJobs.front());
+        myJobs.pop_front();
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myClosed = true;
+        }
+        myReady.notify_all();
+    }
+
+private:
+    std::mutex myMutex;
+    std::condition_variable myReady;
+    std::deque<Job> myJobs;
+    bool myClosed = false;
+};
+
+// Workers that convert queued jobs until the queue closes.
+class WorkerPool {
+public:
+    WorkerPool(JobQueue& queue, const ConvertOptions& options, unsigned workers) : myOptions(options) {
+        myOptions.cancel = &theCancelRequested;
+        for (unsigned w = 0; w < std::max(1u, workers); ++w) {
+            myThreads.emplace_back([&queue, this] {
+                Job job;
+                while (queue.Pop(job)) {
+                    const bool ok = ConvertStepFile(job.stepFile, job.hdf5File, myOptions);
+                    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - job.received).count();
+                    job.done(ok, ms);
+
+                    std::lock_guard<std::mutex> lock(myLogMutex);
+                    ++myJobs;
+                    myFailures += ok ? 0 : 1;
+                    myTotalMs += ms;
+                    std::cout << (ok ? "OK   " : "FAIL ") << ms << " ms " << job.stepFile << " -> " << job.hdf5File
+                              << std::endl;
+                }
+            });
+        }
+    }
+
+    void Join() {
+        for (std::thread& t : myThreads) {
+            t.join();
+        }
+        myThreads.clear();
+        std::cout << "Converted " << myJobs - myFailures << "/" << myJobs << " jobs, mean latency "
+                  << (myJobs ? myTotalMs / static_cast<double>(myJobs) : 0.0) << " ms" << std::endl;
+    }
+
+private:
+    ConvertOptions myOptions;
+    std::vector<std::thread> myThreads;
+    std::mutex myLogMutex;
+    size_t myJobs = 0;
+    size_t myFailures = 0;
+    double myTotalMs = 0.0;
+};
+
+// Client socket, closed once the reader and every job replying on it are done.
+class Connection {
+public:
+    explicit Connection(int fd) : myFd(fd) {}
+    ~Connection() { ::close(myFd); }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    int Fd() const { return myFd; }
+
+    void Reply(const std::string& line) {
+        std::lock_guard<std::mutex> lock(myMutex);
+        for (size_t sent = 0; sent < line.size();) {
+            const ssize_t n = ::send(myFd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int myFd;
+    std::mutex myMutex;
+};
+
+// Counts the client reader threads so shutdown can wait for them.
+class ReaderCount {
+public:
+    void Enter() {
+        std::lock_guard<std::mutex> lock(myMutex);
+        ++myCount;
+    }
+
+    void Leave() {
+        // Notify under the lock: WaitIdle may destroy this object as soon as it wakes
+        std::lock_guard<std::mutex> lock(myMutex);
+        --myCount;
+        myIdle.notify_all();
+    }
+
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(myMutex);
+        myIdle.wait(lock, [this] { return myCount == 0; });
+    }
+
+private:
+    std::mutex myMutex;
+    std::condition_variable myIdle;
+    int myCount = 0;
+};
+
+void ReadJobs(std::shared_ptr<Connection> connection, JobQueue& queue, const std::string& outputDir) {
+    std::string pending;
+    char buffer[4096];
+    while (!theStopRequested) {
+        pollfd client{connection->Fd(), POLLIN, 0};
+        if (::poll(&client, 1, thePollMs) <= 0) continue;
+        const ssize_t n = ::read(connection->Fd(), buffer, sizeof(buffer));
+        if (n <= 0) break;
+        pending.append(buffer, static_cast<size_t>(n));
+
+        for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n')) {
+            std::string line = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            Job job;
+            const size_t tab = line.find('\t');
+            job.stepFile = line.substr(0, tab);
+            job.hdf5File = tab == std::string::npos ? OutputPathFor(job.stepFile, outputDir) : line.substr(tab + 1);
+            job.received = Clock::now();
+            job.done = [connection, stepFile = job.stepFile, hdf5File = job.hdf5File](bool ok, double ms) {
+                connection->Reply((ok ? "OK " : "FAIL ") + std::to_string(ms) + " " + stepFile + " -> " + hdf5File +
+                                  "\n");
+            };
+            queue.Push(std::move(job));
+        }
+    }
+}
+
+// Move found into work as "<sequence>-<name>". The rename never replaces a
+// file, so a resubmitted name cannot overwrite a job that is still queued
+// or running. Returns an empty path when another process claimed it first.
+fs::path ClaimSpoolFile(const fs::path& found, const fs::path& work, uint64_t& sequence) {
+    const std::string name = found.filename().string();
+    for (;;) {
+        const fs::path claimed = work / (std::to_string(sequence++) + "-" + name);
+        if (::renameat2(AT_FDCWD, found.c_str(), AT_FDCWD, claimed.c_str(), RENAME_NOREPLACE) == 0) return claimed;
+        // Left from an earlier run of the daemon: try the next number
+        if (errno != EEXIST) return {};
+    }
+}
+
+} // namespace
+
+int ServeSocket(const std::string& socketPath, const std::string& outputDir, const ConvertOptions& options,
+                unsigned workers) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << "\n";
+        return 1;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ::unlink(socketPath.c_str()); // left behind by a daemon that did not shut down
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (listener >= 0) ::close(listener);
+        return 1;
+    }
+    if (!outputDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(outputDir, ec);
+    }
+
+    InitializeConverter();
+    InstallStopHandlers();
+    JobQueue queue;
+    WorkerPool pool(queue, options, workers);
+    ReaderCount readers;
+    std::cout << "Listening on " << socketPath << std::endl;
+
+    while (!theStopRequested) {
+        pollfd accepting{listener, POLLIN, 0};
+        if (::poll(&accepting, 1, thePollMs) <= 0) continue;
+        const int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+
+        readers.Enter();
+        std::thread([connection = std::make_shared<Connection>(client), &queue, &outputDir, &readers] {
+            ReadJobs(connection, queue, outputDir);
+            readers.Leave();
+        }).detach();
+    }
+
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+    readers.WaitIdle();
+    queue.Close();
+    pool.Join();
+    return 0;
+}
+
+int ServeSpool(const std::string& spoolDir, const std::string& outputDir, const ConvertOptions& options,
+               unsigned workers) {
+    const fs::path work = fs::path(spoolDir) / "work";
+    const fs::path done = fs::path(spoolDir) / "done";
+    const fs::path failed = fs::path(spoolDir) / "failed";
+    std::error_code ec;
+    for (const fs::path& dir : {work, done, failed}) {
+        fs::create_directories(dir, ec);
+        if (ec) {
+            std::cerr << "Cannot create " << dir.string() << ": " << ec.message() << "\n";
+            return 1;
+        }
+    }
+    if (!outputDir.empty()) {
+        fs::create_directories(outputDir, ec);
+    }
+
+    InitializeConverter();
+    InstallStopHandlers();
+    JobQueue queue;
+    WorkerPool pool(queue, options, workers);
+    std::cout << "Watching " << spoolDir << std::endl;
+
+    uint64_t sequence = 0;
+    while (!theStopRequested) {
+        for (const std::string& found : CollectStepFiles(spoolDir)) {
+            // Claiming by rename keeps a file from being picked up twice
+            const fs::path name = fs::path(found).filename();
+            const fs::path claimed = ClaimSpoolFile(found, work, sequence);
+            if (claimed.empty()) continue;
+
+            Job job;
+            job.stepFile = claimed.string();
+            job.hdf5File = OutputPathFor((done / name).string(), outputDir);
+            job.received = Clock::now();
+            job.done = [claimed, name, done, failed](bool ok, double) {
+                std::error_code renameError;
+                fs::rename(claimed, (ok ? done : failed) / name, renameError);
+            };
+            queue.Push(std::move(job));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(thePollMs));
+    }
+
+    queue.Close();
+    pool.Join();
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef CONVERSIONDAEMON_6D2F8B14_A93E_4C07_B5E1_2C7A94D0F368
+#define CONVERSIONDAEMON_6D2F8B14_A93E_4C07_B5E1_2C7A94D0F368
+
+#include "StepToH5Converter.h"
+
+#include <string>
+
+// Long-running converters. OCCT and the XCAF application are initialized
+// once, and every job then runs on a pool of warm workers. Each finished job
+// is logged with its latency from arrival to completion. SIGINT or SIGTERM
+// stops taking jobs, finishes the queued ones and returns; a second signal
+// cancels the running and queued conversions instead of finishing them.
+
+// Accept jobs on a Unix stream socket at socketPath. A client writes one job
+// per line: the input path, optionally a tab and the output path. For each
+// job it reads back "OK <ms> <input> -> <output>" or "FAIL ...", in the
+// order the jobs finish. Returns non-zero when the socket cannot be opened.
+int ServeSocket(const std::string& socketPath, const std::string& outputDir, const ConvertOptions& options,
+                unsigned workers);
+
+// Watch spoolDir for STEP files. Each file is claimed into spoolDir/work,
+// converted and then moved to spoolDir/done or spoolDir/failed. Outputs go
+// to outputDir, or into done next to their input. Producers should write
+// elsewhere and rename files into spoolDir, so that no half-written file is
+// claimed.
+int ServeSpool(const std::string& spoolDir, const std::string& outputDir, const ConvertOptions& options,
+               unsigned workers);
+
+#endif /* CONVERSIONDAEMON_6D2F8B14_A93E_4C07_B5E1_2C7A94D0F368 */
@@ -0,0 +1,146 @@
+#include "ConversionProfile.h"
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+int64_t PeakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<int64_t>(usage.ru_maxrss); // kilobytes on Linux
+}
+
+std::string JsonEscape(const std::string& str) {
+    std::string out;
+    out.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+void WriteDoubleAttribute(H5::Group& group, const std::string& name, double value) {
+    group.createAttribute(name, H5::PredType::IEEE_F64LE, H5::DataSpace())
+         .write(H5::PredType::NATIVE_DOUBLE, &value);
+}
+
+void WriteInt64Attribute(H5::Group& group, const std::string& name, int64_t value) {
+    group.createAttribute(name, H5::PredType::STD_I64LE, H5::DataSpace())
+         .write(H5::PredType::NATIVE_INT64, &value);
+}
+
+herr_t CountLink(hid_t, const char*, const H5L_info_t*, void* count) {
+    ++*static_cast<int64_t*>(count);
+    return 0;
+}
+
+} // namespace
+
+ConversionProfile::Phase::Phase(ConversionProfile* profile, const char* name)
+    : myProfile(profile), myName(name) {
+    if (myProfile) {
+        myWallStart = std::chrono::steady_clock::now();
+        myCpuStart = ProcessCpuSeconds();
+    }
+}
+
+void ConversionProfile::Phase::Stop() {
+    if (!myProfile) return;
+
+    PhaseRecord record;
+    record.name = myName;
+    record.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - myWallStart).count();
+    record.processCpuSeconds = ProcessCpuSeconds() - myCpuStart;
+    record.processPeakRssKb = PeakRssKb();
+    myProfile->myPhases.push_back(record);
+    myProfile = nullptr;
+}
+
+void ConversionProfile::SetCounter(const std::string& name, int64_t value) {
+    for (auto& counter : myCounters) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    myCounters.emplace_back(name, value);
+}
+
+void ConversionProfile::AddCounter(const std::string& name, int64_t delta) {
+    for (auto& counter : myCounters) {
+        if (counter.first == name) {
+            counter.second += delta;
+            return;
+        }
+    }
+    myCounters.emplace_back(name, delta);
+}
+
+std::string ConversionProfile::ToJson(const std::string& stepFile, const std::string& hdf5File) const {
+    std::ostringstream out;
+    out << "{\n  \"input\": \"" << JsonEscape(stepFile) << "\",\n"
+        << "  \"output\": \"" << JsonEscape(hdf5File) << "\",\n"
+        << "  \"phases\": [";
+    for (size_t i = 0; i < myPhases.size(); ++i) {
+        const PhaseRecord& phase = myPhases[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << JsonEscape(phase.name) << "\", \"wall_s\": " << phase.wallSeconds
+            << ", \"process_cpu_s\": " << phase.processCpuSeconds
+            << ", \"process_peak_rss_kb\": " << phase.processPeakRssKb << "}";
+    }
+    out << "\n  ],\n  \"counters\": {";
+    for (size_t i = 0; i < myCounters.size(); ++i) {
+        out << (i == 0 ? "\n" : ",\n")
+            << "    \"" << JsonEscape(myCounters[i].first) << "\": " << myCounters[i].second;
+    }
+    out << "\n  }\n}\n";
+    return out.str();
+}
+
+bool ConversionProfile::WriteJson(const std::string& path, const std::string& stepFile,
+                                  const std::string& hdf5File) const {
+    std::ofstream out(path);
+    out << ToJson(stepFile, hdf5File);
+    return static_cast<bool>(out);
+}
+
+void ConversionProfile::WriteAttributes(H5::Group& group) const {
+    for (const PhaseRecord& phase : myPhases) {
+        WriteDoubleAttribute(group, phase.name + "_wall_s", phase.wallSeconds);
+        WriteDoubleAttribute(group, phase.name + "_process_cpu_s", phase.processCpuSeconds);
+        WriteInt64Attribute(group, phase.name + "_process_peak_rss_kb", phase.processPeakRssKb);
+    }
+    for (const auto& counter : myCounters) {
+        WriteInt64Attribute(group, counter.first, counter.second);
+    }
+}
+
+int64_t ConversionProfile::CountHdf5Objects(const H5::H5File& file) {
+    int64_t count = 0;
+    H5Lvisit(file.getId(), H5_INDEX_NAME, H5_ITER_NATIVE, CountLink, &count);
+    return count;
+}
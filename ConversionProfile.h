@@ -0,0 +1,64 @@
+#ifndef CONVERSIONPROFILE_3F6A2C90_B1D4_4E7A_95C8_0D2E7B4A1F63
+#define CONVERSIONPROFILE_3F6A2C90_B1D4_4E7A_95C8_0D2E7B4A1F63
+
+#include <H5Cpp.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wall time, CPU time and peak RSS per conversion phase, plus named counters.
+// Reported as JSON and as attributes of a /profile group. CPU time and RSS
+// are those of the whole process, so they include the OSD_Parallel workers
+// of a phase, but also any other conversion running in the same process.
+class ConversionProfile {
+public:
+    struct PhaseRecord {
+        std::string name;
+        double wallSeconds = 0.0;
+        double processCpuSeconds = 0.0;
+        int64_t processPeakRssKb = 0; // process peak RSS when the phase ended
+    };
+
+    // Times the enclosing scope. A null profile makes it a no-op.
+    class Phase {
+    public:
+        Phase(ConversionProfile* profile, const char* name);
+        ~Phase() { Stop(); }
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        void Stop();
+
+    private:
+        ConversionProfile* myProfile;
+        const char* myName;
+        std::chrono::steady_clock::time_point myWallStart;
+        double myCpuStart = 0.0;
+    };
+
+    // Set a counter, replacing a previous value of the same name.
+    void SetCounter(const std::string& name, int64_t value);
+    void AddCounter(const std::string& name, int64_t delta);
+
+    const std::vector<PhaseRecord>& Phases() const { return myPhases; }
+    const std::vector<std::pair<std::string, int64_t>>& Counters() const { return myCounters; }
+
+    std::string ToJson(const std::string& stepFile, const std::string& hdf5File) const;
+    bool WriteJson(const std::string& path, const std::string& stepFile, const std::string& hdf5File) const;
+
+    // One <phase>_wall_s / _process_cpu_s / _process_peak_rss_kb attribute per
+    // phase and one per counter.
+    void WriteAttributes(H5::Group& group) const;
+
+    // Number of links (groups, datasets) reachable from the root of file.
+    static int64_t CountHdf5Objects(const H5::H5File& file);
+
+private:
+    std::vector<PhaseRecord> myPhases;
+    std::vector<std::pair<std::string, int64_t>> myCounters;
+};
+
+#endif /* CONVERSIONPROFILE_3F6A2C90_B1D4_4E7A_95C8_0D2E7B4A1F63 */
@@ -0,0 +1,93 @@
+#include "ConversionProgress.h"
+
+#include "ConversionProfile.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+ConversionProgress::ConversionProgress(const std::string& stepFile, double reportSeconds, double deadlineSeconds,
+                                       const std::atomic<bool>* cancel, ConversionProfile* profile)
+    : myStepFile(stepFile),
+      myReportInterval(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds))),
+      myHasDeadline(deadlineSeconds > 0.0),
+      myCancel(cancel),
+      myProfile(profile),
+      myPhaseStart(Clock::now()),
+      myLastReport(myPhaseStart) {
+    myDeadline = myPhaseStart;
+    if (myHasDeadline) {
+        myDeadline += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(deadlineSeconds));
+    }
+}
+
+Message_ProgressRange ConversionProgress::Begin(const char* name, const char* unit, double total) {
+    myPhase = name;
+    myUnit = unit;
+    myTotal = total;
+    myPhaseStart = Clock::now();
+    myLastReport = myPhaseStart;
+    return Start();
+}
+
+void ConversionProgress::End(double items) {
+    const double seconds = PhaseSeconds();
+    const double rate = seconds > 0.0 ? items / seconds : 0.0;
+    if (myProfile) {
+        const std::string name = std::strcmp(myPhase, myUnit) == 0 ? myPhase : std::string(myPhase) + "_" + myUnit;
+        myProfile->SetCounter(name + "_per_s", std::llround(rate));
+    }
+    if (myReportInterval > Clock::duration::zero()) {
+        std::ostringstream line;
+        line << myStepFile << ": " << myPhase << " done, " << std::llround(items) << " " << myUnit << " in "
+             << seconds << " s, " << std::llround(rate) << " " << myUnit << "/s\n";
+        std::cerr << line.str();
+    }
+}
+
+Standard_Boolean ConversionProgress::UserBreak() {
+    if (myStopReason.load() != nullptr) return Standard_True;
+    if (myCancel && myCancel->load()) {
+        myStopReason = "cancelled";
+    } else if (myHasDeadline && Clock::now() >= myDeadline) {
+        myStopReason = "deadline exceeded";
+    }
+    return myStopReason.load() != nullptr;
+}
+
+bool ConversionProgress::Stopped() {
+    if (!UserBreak()) return false;
+    if (!myStopReported) {
+        myStopReported = true;
+        std::cerr << "Stopped " << myStepFile << " in phase " << myPhase << ": " << myStopReason.load() << "\n";
+    }
+    return true;
+}
+
+void ConversionProgress::Show(const Message_ProgressScope& scope, const Standard_Boolean) {
+    // OCCT serializes the calls; Begin and End only run between phases
+    if (myReportInterval <= Clock::duration::zero()) return;
+    const Clock::time_point now = Clock::now();
+    if (now - myLastReport < myReportInterval) return;
+    myLastReport = now;
+
+    // Open-ended loops count their items on an infinite scope
+    const double items = myTotal > 0.0 ? GetPosition() * myTotal : (scope.IsInfinite() ? scope.Value() : 0.0);
+    const double seconds = PhaseSeconds();
+    std::ostringstream line;
+    line << myStepFile << ": " << myPhase;
+    if (myTotal > 0.0) {
+        line << " " << std::lround(GetPosition() * 100.0) << "%";
+    }
+    if (items > 0.0) {
+        line << ", " << std::llround(items) << " " << myUnit << ", " << std::llround(items / seconds) << " " << myUnit
+             << "/s";
+    }
+    line << ", " << seconds << " s\n";
+    std::cerr << line.str();
+}
+
+double ConversionProgress::PhaseSeconds() const {
+    return std::chrono::duration<double>(Clock::now() - myPhaseStart).count();
+}
@@ -0,0 +1,69 @@
+#ifndef CONVERSIONPROGRESS_8C1F4E27_D35A_4B96_A2E0_71B6F9C3D584
+#define CONVERSIONPROGRESS_8C1F4E27_D35A_4B96_A2E0_71B6F9C3D584
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressRange.hxx>
+#include <Message_ProgressScope.hxx>
+#include <Standard_Type.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+class ConversionProfile;
+
+// Progress of one conversion, one phase at a time. OCCT algorithms and the
+// converter's own loops advance it through Message_ProgressRange; it prints
+// the phase, its completion and its rate on std::cerr at most once per report
+// interval, and makes every scope stop once the deadline has passed or the
+// cancel flag is set.
+class ConversionProgress : public Message_ProgressIndicator {
+public:
+    // reportSeconds <= 0 prints nothing, deadlineSeconds <= 0 sets no deadline.
+    // The deadline counts from construction. cancel may be null.
+    ConversionProgress(const std::string& stepFile, double reportSeconds, double deadlineSeconds,
+                       const std::atomic<bool>* cancel, ConversionProfile* profile);
+
+    // Restart the indicator for phase `name`, which handles `total` items of
+    // `unit` (0 when not known up front), and return the range to pass to it.
+    Message_ProgressRange Begin(const char* name, const char* unit, double total = 0.0);
+
+    // Close the phase begun last after it handled `items` items. Prints the
+    // rate and, with a profile, sets the <name>_<unit>_per_s counter
+    // (<name>_per_s when the two are the same).
+    void End(double items);
+
+    // True once the deadline has passed or cancel is set.
+    Standard_Boolean UserBreak() override;
+
+    // UserBreak() for the converter between phases. The first call that sees
+    // the break says on std::cerr why and in which phase the file stopped.
+    bool Stopped();
+
+    DEFINE_STANDARD_RTTI_INLINE(ConversionProgress, Message_ProgressIndicator)
+
+protected:
+    void Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double PhaseSeconds() const;
+
+    std::string myStepFile;
+    Clock::duration myReportInterval;
+    Clock::time_point myDeadline;
+    bool myHasDeadline;
+    const std::atomic<bool>* myCancel;
+    ConversionProfile* myProfile;
+
+    const char* myPhase = "start";
+    const char* myUnit = "";
+    double myTotal = 0.0;
+    Clock::time_point myPhaseStart;
+    Clock::time_point myLastReport;
+    std::atomic<const char*> myStopReason{nullptr};
+    bool myStopReported = false;
+};
+
+#endif /* CONVERSIONPROGRESS_8C1F4E27_D35A_4B96_A2E0_71B6F9C3D584 */
@@ -0,0 +1,140 @@
+#ifndef H5APPENDWRITER_9B3D6E21_7A4C_4F15_8C2E_61D0A5F3B7C8
+#define H5APPENDWRITER_9B3D6E21_7A4C_4F15_8C2E_61D0A5F3B7C8
+
+#include <H5Cpp.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Storage settings shared by every table of one output file.
+struct H5WriterSettings {
+    hsize_t chunkRows = 16384; // rows per chunk and per flush
+    int deflateLevel = 4;      // 0 disables compression
+};
+
+// Appends rows of `columns` values to an extensible (H5S_UNLIMITED), chunked
+// and optionally deflate-compressed dataset. Rows are buffered in memory and
+// written one chunk-aligned hyperslab at a time, so the number of HDF5 calls
+// grows with the data size instead of with the row count.
+//
+// The dataset is created on the first flush: a table that fits in a single
+// chunk gets a chunk of exactly its own size.
+template <typename T>
+class H5AppendWriter {
+public:
+    H5AppendWriter(const H5::Group& group, const std::string& name,
+                   const H5::PredType& fileType, const H5::PredType& memType,
+                   hsize_t columns = 1, const H5WriterSettings& settings = H5WriterSettings())
+        : myGroup(group), myName(name), myFileType(fileType), myMemType(memType),
+          myColumns(columns), mySettings(settings) {
+        mySettings.chunkRows = std::max<hsize_t>(1, mySettings.chunkRows);
+        myBuffer.reserve(static_cast<size_t>(mySettings.chunkRows * myColumns));
+    }
+
+    ~H5AppendWriter() {
+        try {
+            Close();
+        } catch (...) {
+        }
+    }
+
+    H5AppendWriter(const H5AppendWriter&) = delete;
+    H5AppendWriter& operator=(const H5AppendWriter&) = delete;
+
+    // Append one row of `columns` values.
+    void AppendRow(const T* row) { Append(row, 1); }
+
+    void Append(const T& value) { Append(&value, 1); }
+
+    // Append nbRows consecutive rows. Whole chunks are written straight from
+    // values when nothing is pending in the buffer.
+    void Append(const T* values, size_t nbRows) {
+        while (nbRows > 0) {
+            if (myBuffer.empty() && nbRows >= mySettings.chunkRows) {
+                const hsize_t direct = (nbRows / mySettings.chunkRows) * mySettings.chunkRows;
+                WriteRows(values, direct);
+                values += direct * myColumns;
+                nbRows -= static_cast<size_t>(direct);
+                continue;
+            }
+
+            const hsize_t pending = myBuffer.size() / myColumns;
+            const size_t take = static_cast<size_t>(std::min<hsize_t>(nbRows, mySettings.chunkRows - pending));
+            myBuffer.insert(myBuffer.end(), values, values + take * myColumns);
+            values += take * myColumns;
+            nbRows -= take;
+            if (myBuffer.size() / myColumns == mySettings.chunkRows) {
+                Flush();
+            }
+        }
+    }
+
+    // Write whatever is buffered.
+    void Flush() {
+        if (!myBuffer.empty()) {
+            WriteRows(myBuffer.data(), myBuffer.size() / myColumns);
+            myBuffer.clear();
+        }
+    }
+
+    // Flush and make sure the dataset exists, even when no row was appended.
+    H5::DataSet& Close() {
+        Flush();
+        if (!myCreated) {
+            Create(0);
+        }
+        return myDataSet;
+    }
+
+    hsize_t Rows() const { return myRows + myBuffer.size() / myColumns; }
+
+private:
+    void Create(hsize_t firstRows) {
+        hsize_t dims[2] = {0, myColumns};
+        hsize_t maxDims[2] = {H5S_UNLIMITED, myColumns};
+        hsize_t chunk[2] = {std::max<hsize_t>(1, std::min(firstRows, mySettings.chunkRows)), myColumns};
+        const int rank = myColumns == 1 ? 1 : 2;
+
+        H5::DSetCreatPropList props;
+        props.setChunk(rank, chunk);
+        if (mySettings.deflateLevel > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+            props.setShuffle();
+            props.setDeflate(mySettings.deflateLevel);
+        }
+        myDataSet = myGroup.createDataSet(myName, myFileType, H5::DataSpace(rank, dims, maxDims), props);
+        myCreated = true;
+    }
+
+    void WriteRows(const T* values, hsize_t nbRows) {
+        if (!myCreated) {
+            // A first write that is also the last one sizes the chunk to the table
+            Create(nbRows);
+        }
+        const int rank = myColumns == 1 ? 1 : 2;
+        hsize_t newDims[2] = {myRows + nbRows, myColumns};
+        myDataSet.extend(newDims);
+
+        hsize_t offset[2] = {myRows, 0};
+        hsize_t count[2] = {nbRows, myColumns};
+        H5::DataSpace fileSpace = myDataSet.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace memSpace(rank, count);
+        myDataSet.write(values, myMemType, memSpace, fileSpace);
+        myRows += nbRows;
+    }
+
+    H5::Group myGroup;
+    std::string myName;
+    H5::PredType myFileType;
+    H5::PredType myMemType;
+    hsize_t myColumns;
+    H5WriterSettings mySettings;
+
+    H5::DataSet myDataSet;
+    bool myCreated = false;
+    hsize_t myRows = 0;
+    std::vector<T> myBuffer;
+};
+
+#endif /* H5APPENDWRITER_9B3D6E21_7A4C_4F15_8C2E_61D0A5F3B7C8 */
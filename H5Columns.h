@@ -0,0 +1,27 @@
+#ifndef H5COLUMNS_5C1E2B7A_4D0F_4E8B_9A63_2F7C1D8E4B90
+#define H5COLUMNS_5C1E2B7A_4D0F_4E8B_9A63_2F7C1D8E4B90
+
+#include <H5Cpp.h>
+
+#include "H5AppendWriter.h"
+
+#include <cstdint>
+#include <vector>
+
+// Write values as a chunked dataset called name under group, with
+// `columns` values per row.
+template <typename T>
+void WriteColumn(H5::Group& group, const char* name, const std::vector<T>& values,
+                 const H5::PredType& fileType, const H5::PredType& memType,
+                 const H5WriterSettings& settings, hsize_t columns = 1) {
+    H5AppendWriter<T> writer(group, name, fileType, memType, columns, settings);
+    writer.Append(values.data(), values.size() / columns);
+    writer.Close();
+}
+
+inline void WriteInt32Column(H5::Group& group, const char* name, const std::vector<int32_t>& values,
+                             const H5WriterSettings& settings) {
+    WriteColumn(group, name, values, H5::PredType::STD_I32LE, H5::PredType::NATIVE_INT32, settings);
+}
+
+#endif /* H5COLUMNS_5C1E2B7A_4D0F_4E8B_9A63_2F7C1D8E4B90 */
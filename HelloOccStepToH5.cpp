@@ -0,0 +1,356 @@
+#include "HelloOccStepToH5.h"
+
+#include <H5Cpp.h>
+
+#include "NameNormalization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+template <typename T>
+std::vector<T> ReadColumn(const H5::Group& group, const char* name, const H5::PredType& memType) {
+    H5::DataSet dataset = group.openDataSet(name);
+    std::vector<T> values(static_cast<size_t>(dataset.getSpace().getSimpleExtentNpoints()));
+    if (!values.empty()) {
+        dataset.read(values.data(), memType);
+    }
+    return values;
+}
+
+// offsets[i] .. offsets[i+1] delimit entry i of a size-long column
+bool IsOffsetColumn(const std::vector<uint64_t>& offsets, size_t size) {
+    return !offsets.empty() && offsets.back() <= size && std::is_sorted(offsets.begin(), offsets.end());
+}
+
+// Every column has one entry per row and every parent precedes its row, as
+// pre-order requires; name ids index the string heap
+bool IsLabelTable(const std::vector<int32_t>& parent, const std::vector<int32_t>& tag,
+                  const std::vector<int32_t>& depth, const std::vector<int32_t>& name,
+                  const std::vector<uint64_t>& stringOffsets, size_t nbStringBytes) {
+    const size_t nbRows = tag.size();
+    if (parent.size() != nbRows || depth.size() != nbRows || name.size() != nbRows) return false;
+    for (size_t row = 1; row < nbRows; ++row) {
+        if (parent[row] < 0 || static_cast<size_t>(parent[row]) >= row) return false;
+    }
+
+    if (!IsOffsetColumn(stringOffsets, nbStringBytes)) return false;
+    const size_t nbStrings = stringOffsets.size() - 1;
+    return std::all_of(name.begin(), name.end(),
+                       [nbStrings](int32_t id) { return id < 0 || static_cast<size_t>(id) < nbStrings; });
+}
+
+// One row range per key, and every row within the label table
+bool IsNameIndex(const std::vector<uint64_t>& keyOffsets, size_t nbKeyBytes, const std::vector<uint64_t>& rowOffsets,
+                 const std::vector<int32_t>& rows, size_t nbRows) {
+    if (!IsOffsetColumn(keyOffsets, nbKeyBytes) || !IsOffsetColumn(rowOffsets, rows.size())) return false;
+    if (rowOffsets.size() != keyOffsets.size()) return false;
+    return std::all_of(rows.begin(), rows.end(),
+                       [nbRows](int32_t row) { return row >= 0 && static_cast<size_t>(row) < nbRows; });
+}
+
+// Inner nodes (count 0) name two children after themselves, as breadth-first
+// order puts them, so a traversal ends; leaves name items of occurrence rows
+bool IsBvh(const std::vector<float>& nodeBox, const std::vector<int32_t>& nodeFirst,
+           const std::vector<int32_t>& nodeCount, const std::vector<int32_t>& items,
+           const std::vector<float>& occurrenceBox) {
+    const size_t nbNodes = nodeFirst.size();
+    if (nodeCount.size() != nbNodes || nodeBox.size() != nbNodes * 6 || occurrenceBox.size() % 6 != 0) return false;
+    for (size_t node = 0; node < nbNodes; ++node) {
+        const int64_t first = nodeFirst[node];
+        const int64_t count = nodeCount[node];
+        const bool inner = count == 0 && first > static_cast<int64_t>(node) && first + 1 < static_cast<int64_t>(nbNodes);
+        const bool leaf = count > 0 && first >= 0 && first + count <= static_cast<int64_t>(items.size());
+        if (!inner && !leaf) return false;
+    }
+    const size_t nbOccurrences = occurrenceBox.size() / 6;
+    return std::all_of(items.begin(), items.end(), [nbOccurrences](int32_t item) {
+        return item >= 0 && static_cast<size_t>(item) < nbOccurrences;
+    });
+}
+
+// Slab test; tNear receives the distance at which the ray enters the box
+bool RayHitsBox(const float* box, const std::array<float, 3>& origin, const std::array<float, 3>& inverse,
+                float& tNear) {
+    float tMin = 0.0f;
+    float tMax = INFINITY;
+    for (int axis = 0; axis < 3; ++axis) {
+        float t0 = (box[axis] - origin[axis]) * inverse[axis];
+        float t1 = (box[axis + 3] - origin[axis]) * inverse[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        // NaN from 0 * inf (origin on a slab of a parallel ray) keeps the bound
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+        if (tMin > tMax) return false;
+    }
+    tNear = tMin;
+    return true;
+}
+
+} // namespace
+
+bool StepH5Reader::Open(const std::string& hdf5File) {
+    // Load into a fresh reader so that no table of an earlier file survives
+    StepH5Reader loaded;
+    const bool opened = loaded.Load(hdf5File);
+    *this = opened ? std::move(loaded) : StepH5Reader();
+    return opened;
+}
+
+bool StepH5Reader::Load(const std::string& hdf5File) {
+    try {
+        H5::H5File file(hdf5File, H5F_ACC_RDONLY);
+        H5::Group labels = file.openGroup("/labels");
+        myParent = ReadColumn<int32_t>(labels, "parent", H5::PredType::NATIVE_INT32);
+        myTag = ReadColumn<int32_t>(labels, "tag", H5::PredType::NATIVE_INT32);
+        myDepth = ReadColumn<int32_t>(labels, "depth", H5::PredType::NATIVE_INT32);
+        myName = ReadColumn<int32_t>(labels, "name", H5::PredType::NATIVE_INT32);
+        H5::Attribute rootEntry = labels.openAttribute("root_entry");
+        rootEntry.read(rootEntry.getStrType(), myRootEntry);
+
+        H5::Group strings = file.openGroup("/strings");
+        std::vector<uint8_t> bytes = ReadColumn<uint8_t>(strings, "data", H5::PredType::NATIVE_UINT8);
+        myStringBytes.assign(bytes.begin(), bytes.end());
+        myStringOffsets = ReadColumn<uint64_t>(strings, "offsets", H5::PredType::NATIVE_UINT64);
+
+        // Written by the converter since the index was added; older files have none
+        if (file.nameExists("/name_index")) {
+            H5::Group names = file.openGroup("/name_index");
+            std::vector<uint8_t> keys = ReadColumn<uint8_t>(names, "key_data", H5::PredType::NATIVE_UINT8);
+            myKeyBytes.assign(keys.begin(), keys.end());
+            myKeyOffsets = ReadColumn<uint64_t>(names, "key_offsets", H5::PredType::NATIVE_UINT64);
+            myKeyRowOffsets = ReadColumn<uint64_t>(names, "row_offsets", H5::PredType::NATIVE_UINT64);
+            myKeyRows = ReadColumn<int32_t>(names, "rows", H5::PredType::NATIVE_INT32);
+        }
+
+        // Only present for files converted with --bvh
+        if (file.nameExists("/bvh")) {
+            H5::Group bounds = file.openGroup("/bounds");
+            myOccurrenceBox = ReadColumn<float>(bounds, "occurrence_box", H5::PredType::NATIVE_FLOAT);
+            H5::Group bvh = file.openGroup("/bvh");
+            myNodeBox = ReadColumn<float>(bvh, "node_box", H5::PredType::NATIVE_FLOAT);
+            myNodeFirst = ReadColumn<int32_t>(bvh, "node_first", H5::PredType::NATIVE_INT32);
+            myNodeCount = ReadColumn<int32_t>(bvh, "node_count", H5::PredType::NATIVE_INT32);
+            myNodeItems = ReadColumn<int32_t>(bvh, "items", H5::PredType::NATIVE_INT32);
+        }
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+        return false;
+    }
+    if (!IsLabelTable(myParent, myTag, myDepth, myName, myStringOffsets, myStringBytes.size())) {
+        std::cerr << "Malformed label table: " << hdf5File << "\n";
+        return false;
+    }
+    const bool hasNameIndex = !myKeyOffsets.empty() || !myKeyRowOffsets.empty() || !myKeyRows.empty();
+    if (hasNameIndex && !IsNameIndex(myKeyOffsets, myKeyBytes.size(), myKeyRowOffsets, myKeyRows, Size())) {
+        std::cerr << "Malformed /name_index: " << hdf5File << "\n";
+        return false;
+    }
+    if (!IsBvh(myNodeBox, myNodeFirst, myNodeCount, myNodeItems, myOccurrenceBox)) {
+        std::cerr << "Malformed /bvh: " << hdf5File << "\n";
+        return false;
+    }
+
+    // Children CSR; pre-order keeps each range in row order, sorted by tag below
+    const size_t nbRows = Size();
+    myChildOffset.assign(nbRows + 1, 0);
+    for (size_t row = 1; row < nbRows; ++row) {
+        ++myChildOffset[static_cast<size_t>(myParent[row]) + 1];
+    }
+    for (size_t row = 0; row < nbRows; ++row) {
+        myChildOffset[row + 1] += myChildOffset[row];
+    }
+    myChildren.resize(nbRows > 0 ? nbRows - 1 : 0);
+    std::vector<int32_t> fill(myChildOffset.begin(), myChildOffset.end() - 1);
+    for (size_t row = 1; row < nbRows; ++row) {
+        myChildren[static_cast<size_t>(fill[static_cast<size_t>(myParent[row])]++)] = static_cast<int32_t>(row);
+    }
+    for (size_t row = 0; row < nbRows; ++row) {
+        std::sort(myChildren.begin() + myChildOffset[row], myChildren.begin() + myChildOffset[row + 1],
+                  [this](int32_t a, int32_t b) { return Tag(a) < Tag(b); });
+    }
+
+    // Subtree sizes folded bottom-up: every descendant follows its ancestor
+    std::vector<int32_t> subtreeSize(nbRows, 1);
+    for (size_t row = nbRows; row-- > 1;) {
+        subtreeSize[static_cast<size_t>(myParent[row])] += subtreeSize[row];
+    }
+    mySubtreeEnd.resize(nbRows);
+    for (size_t row = 0; row < nbRows; ++row) {
+        mySubtreeEnd[row] = static_cast<int32_t>(row) + subtreeSize[row];
+    }
+    return true;
+}
+
+int32_t StepH5Reader::Find(std::string_view entry) const {
+    if (Size() == 0 || entry.substr(0, myRootEntry.size()) != myRootEntry) return -1;
+
+    int32_t row = 0;
+    std::string_view rest = entry.substr(myRootEntry.size());
+    while (!rest.empty()) {
+        if (rest.front() != ':') return -1;
+        int32_t tag = 0;
+        const auto [end, ec] = std::from_chars(rest.data() + 1, rest.data() + rest.size(), tag);
+        if (ec != std::errc() || end == rest.data() + 1) return -1;
+        rest.remove_prefix(static_cast<size_t>(end - rest.data()));
+
+        const std::span<const int32_t> children = Children(row);
+        auto found = std::lower_bound(children.begin(), children.end(), tag,
+                                      [this](int32_t child, int32_t value) { return Tag(child) < value; });
+        if (found == children.end() || Tag(*found) != tag) return -1;
+        row = *found;
+    }
+    return row;
+}
+
+std::string StepH5Reader::Entry(int32_t row) const {
+    std::vector<int32_t> tags;
+    for (; row > 0; row = Parent(row)) {
+        tags.push_back(Tag(row));
+    }
+    std::string entry = myRootEntry;
+    for (auto it = tags.rbegin(); it != tags.rend(); ++it) {
+        entry += ':';
+        entry += std::to_string(*it);
+    }
+    return entry;
+}
+
+std::string_view StepH5Reader::Name(int32_t row) const {
+    const int32_t id = myName[static_cast<size_t>(row)];
+    return id < 0 ? std::string_view() : String(id);
+}
+
+std::span<const int32_t> StepH5Reader::Children(int32_t row) const {
+    const size_t begin = static_cast<size_t>(myChildOffset[static_cast<size_t>(row)]);
+    const size_t end = static_cast<size_t>(myChildOffset[static_cast<size_t>(row) + 1]);
+    return std::span<const int32_t>(myChildren.data() + begin, end - begin);
+}
+
+std::string_view StepH5Reader::String(int32_t id) const {
+    const uint64_t begin = myStringOffsets[static_cast<size_t>(id)];
+    const uint64_t end = myStringOffsets[static_cast<size_t>(id) + 1];
+    return std::string_view(myStringBytes).substr(begin, end - begin);
+}
+
+std::span<const int32_t> StepH5Reader::FindByName(std::string_view name) const {
+    const std::string key = NormalizeName(name);
+    const size_t k = LowerKey(key);
+    if (k + 1 >= myKeyOffsets.size() || Key(k) != key) return {};
+    return KeyRows(k, k + 1);
+}
+
+std::span<const int32_t> StepH5Reader::FindByNamePrefix(std::string_view prefix) const {
+    const std::string key = NormalizeName(prefix);
+    const size_t first = LowerKey(key);
+
+    // Keys sharing the prefix form one run starting at first
+    size_t lo = first;
+    size_t hi = myKeyOffsets.empty() ? 0 : myKeyOffsets.size() - 1;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (Key(mid).substr(0, key.size()) == key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return KeyRows(first, lo);
+}
+
+size_t StepH5Reader::LowerKey(std::string_view key) const {
+    size_t lo = 0;
+    size_t hi = myKeyOffsets.empty() ? 0 : myKeyOffsets.size() - 1;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (Key(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+std::string_view StepH5Reader::Key(size_t k) const {
+    return std::string_view(myKeyBytes).substr(myKeyOffsets[k], myKeyOffsets[k + 1] - myKeyOffsets[k]);
+}
+
+std::span<const int32_t> StepH5Reader::KeyRows(size_t first, size_t last) const {
+    if (first >= last) return {};
+    const size_t begin = static_cast<size_t>(myKeyRowOffsets[first]);
+    const size_t end = static_cast<size_t>(myKeyRowOffsets[last]);
+    return std::span<const int32_t>(myKeyRows.data() + begin, end - begin);
+}
+
+std::vector<int32_t> StepH5Reader::QueryBox(const std::array<float, 6>& box) const {
+    auto overlaps = [&box](const float* other) {
+        return other[0] <= box[3] && other[1] <= box[4] && other[2] <= box[5] &&
+               box[0] <= other[3] && box[1] <= other[4] && box[2] <= other[5];
+    };
+
+    std::vector<int32_t> found;
+    if (myNodeFirst.empty()) return found;
+    std::vector<int32_t> stack{0};
+    while (!stack.empty()) {
+        const size_t node = static_cast<size_t>(stack.back());
+        stack.pop_back();
+        if (!overlaps(myNodeBox.data() + node * 6)) continue;
+
+        const int32_t first = myNodeFirst[node];
+        if (myNodeCount[node] == 0) {
+            stack.push_back(first + 1);
+            stack.push_back(first);
+            continue;
+        }
+        for (int32_t i = first; i < first + myNodeCount[node]; ++i) {
+            const int32_t item = myNodeItems[static_cast<size_t>(i)];
+            if (overlaps(myOccurrenceBox.data() + static_cast<size_t>(item) * 6)) found.push_back(item);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::vector<int32_t> StepH5Reader::QueryRay(const std::array<float, 3>& origin,
+                                            const std::array<float, 3>& direction) const {
+    std::vector<std::pair<float, int32_t>> hits;
+    if (myNodeFirst.empty()) return {};
+    const std::array<float, 3> inverse = {1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+
+    std::vector<int32_t> stack{0};
+    float t = 0.0f;
+    while (!stack.empty()) {
+        const size_t node = static_cast<size_t>(stack.back());
+        stack.pop_back();
+        if (!RayHitsBox(myNodeBox.data() + node * 6, origin, inverse, t)) continue;
+
+        const int32_t first = myNodeFirst[node];
+        if (myNodeCount[node] == 0) {
+            stack.push_back(first + 1);
+            stack.push_back(first);
+            continue;
+        }
+        for (int32_t i = first; i < first + myNodeCount[node]; ++i) {
+            const int32_t item = myNodeItems[static_cast<size_t>(i)];
+            if (RayHitsBox(myOccurrenceBox.data() + static_cast<size_t>(item) * 6, origin, inverse, t)) {
+                hits.emplace_back(t, item);
+            }
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+
+    std::vector<int32_t> found(hits.size());
+    std::transform(hits.begin(), hits.end(), found.begin(), [](const auto& hit) { return hit.second; });
+    return found;
+}
+
+std::array<float, 6> StepH5Reader::OccurrenceBox(int32_t occurrence) const {
+    std::array<float, 6> box;
+    std::copy_n(myOccurrenceBox.begin() + static_cast<ptrdiff_t>(occurrence) * 6, 6, box.begin());
+    return box;
+}
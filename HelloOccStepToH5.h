@@ -1,5 +1,99 @@
 #ifndef OPENCASCADEH5_EC87C331_3816_499B_8ED7_DFA8EBDE9201
 #define OPENCASCADEH5_EC87C331_3816_499B_8ED7_DFA8EBDE9201
 
+// Reader for files written by the converter's flat layout. Depends on HDF5
+// only. Open() loads the label and string tables once; every query after that
+// is answered from memory without touching the file.
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class StepH5Reader {
+public:
+    // Load /labels and /strings of hdf5File, replacing what an earlier Open()
+    // loaded. Errors are reported on std::cerr and leave the reader empty.
+    // Not safe to call while another thread of the process uses HDF5.
+    bool Open(const std::string& hdf5File);
+
+    size_t Size() const { return myTag.size(); }
+
+    // Row of an entry such as "0:1:1:11", -1 when absent.
+    // O(depth * log(children)): one binary search per tag of the entry.
+    int32_t Find(std::string_view entry) const;
+
+    // Entry of row, rebuilt from its tags.
+    std::string Entry(int32_t row) const;
+
+    int32_t Parent(int32_t row) const { return myParent[static_cast<size_t>(row)]; }
+    int32_t Tag(int32_t row) const { return myTag[static_cast<size_t>(row)]; }
+    int32_t Depth(int32_t row) const { return myDepth[static_cast<size_t>(row)]; }
+
+    // Name of row, empty when the label has none.
+    std::string_view Name(int32_t row) const;
+
+    // Direct children of row, ordered by tag.
+    std::span<const int32_t> Children(int32_t row) const;
+
+    // Rows are stored in pre-order: the subtree of row is [row, SubtreeEnd(row)).
+    int32_t SubtreeEnd(int32_t row) const { return mySubtreeEnd[static_cast<size_t>(row)]; }
+
+    // Any string of the shared heap by id, e.g. a layer name.
+    std::string_view String(int32_t id) const;
+
+    // Rows whose normalized name (NameNormalization.h) equals name, ascending.
+    // Binary search over /name_index; empty when the file has none.
+    std::span<const int32_t> FindByName(std::string_view name) const;
+
+    // Rows whose normalized name starts with prefix, grouped by name in byte
+    // order and ascending within each name.
+    std::span<const int32_t> FindByNamePrefix(std::string_view prefix) const;
+
+    // Occurrence rows whose world box overlaps box (xmin, ymin, zmin, xmax,
+    // ymax, zmax). Walks /bvh; empty when the file has none.
+    std::vector<int32_t> QueryBox(const std::array<float, 6>& box) const;
+
+    // Occurrence rows whose world box the ray from origin along direction
+    // enters, nearest entry first.
+    std::vector<int32_t> QueryRay(const std::array<float, 3>& origin, const std::array<float, 3>& direction) const;
+
+    // World box of an occurrence row from /bounds/occurrence_box.
+    std::array<float, 6> OccurrenceBox(int32_t occurrence) const;
+
+private:
+    bool Load(const std::string& hdf5File);
+
+    // First name index key not less than key
+    size_t LowerKey(std::string_view key) const;
+    std::string_view Key(size_t k) const;
+    std::span<const int32_t> KeyRows(size_t first, size_t last) const;
+
+    std::vector<int32_t> myParent;
+    std::vector<int32_t> myTag;
+    std::vector<int32_t> myDepth;
+    std::vector<int32_t> myName;
+    std::string myRootEntry;
+
+    std::vector<int32_t> myChildOffset; // Size() + 1 entries, CSR over myChildren
+    std::vector<int32_t> myChildren;
+    std::vector<int32_t> mySubtreeEnd;
+
+    std::string myStringBytes;
+    std::vector<uint64_t> myStringOffsets;
+
+    std::string myKeyBytes;
+    std::vector<uint64_t> myKeyOffsets;
+    std::vector<uint64_t> myKeyRowOffsets;
+    std::vector<int32_t> myKeyRows;
+
+    std::vector<float> myOccurrenceBox; // 6 per occurrence row
+    std::vector<float> myNodeBox;       // 6 per node, breadth-first
+    std::vector<int32_t> myNodeFirst;
+    std::vector<int32_t> myNodeCount;
+    std::vector<int32_t> myNodeItems;
+};
 
 #endif /* OPENCASCADEH5_EC87C331_3816_499B_8ED7_DFA8EBDE9201 */
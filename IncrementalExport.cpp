@@ -0,0 +1,174 @@
+#include "IncrementalExport.h"
+
+#include "ContentHash.h"
+
+#include <filesystem>
+
+namespace {
+
+struct RowRange {
+    hsize_t begin;
+    hsize_t end;
+};
+
+void AddRow(std::vector<RowRange>& ranges, hsize_t row) {
+    if (!ranges.empty() && ranges.back().end == row) {
+        ranges.back().end = row + 1;
+    } else {
+        ranges.push_back({row, row + 1});
+    }
+}
+
+template <typename T>
+std::vector<T> ReadColumn(const H5::Group& group, const char* name, const H5::PredType& memType) {
+    H5::DataSet dataset = group.openDataSet(name);
+    std::vector<T> values(static_cast<size_t>(dataset.getSpace().getSimpleExtentNpoints()));
+    if (!values.empty()) {
+        dataset.read(values.data(), memType);
+    }
+    return values;
+}
+
+// Resize dataset to nbRows and overwrite the given row ranges from values
+// through hyperslab selections; everything else stays untouched on disk.
+template <typename T>
+void WriteRanges(H5::DataSet dataset, const std::vector<T>& values, hsize_t columns,
+                 const std::vector<RowRange>& ranges, const H5::PredType& memType) {
+    const hsize_t nbRows = values.size() / columns;
+    const int rank = dataset.getSpace().getSimpleExtentNdims();
+    hsize_t dims[2] = {nbRows, columns};
+    dataset.extend(dims);
+
+    H5::DataSpace fileSpace = dataset.getSpace();
+    for (const RowRange& range : ranges) {
+        hsize_t offset[2] = {range.begin, 0};
+        hsize_t count[2] = {range.end - range.begin, columns};
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace memSpace(rank, count);
+        dataset.write(values.data() + range.begin * columns, memType, memSpace, fileSpace);
+    }
+}
+
+} // namespace
+
+void ComputeSubtreeHashes(LabelTable& labels, const StringHeap& strings, const MassPropertyTable* properties) {
+    const size_t nbRows = labels.Size();
+    std::vector<int32_t> propertyRow(nbRows, -1);
+    if (properties) {
+        for (size_t i = 0; i < properties->Size(); ++i) {
+            propertyRow[static_cast<size_t>(properties->labelRow[i])] = static_cast<int32_t>(i);
+        }
+    }
+
+    labels.subtreeHash.resize(nbRows);
+    for (size_t row = 0; row < nbRows; ++row) {
+        ContentHash hash;
+        hash.AddValue(labels.tag[row]);
+        hash.Add(labels.name[row] < 0 ? std::string_view() : strings.Get(labels.name[row]));
+        if (propertyRow[row] >= 0) {
+            hash.Add(properties->values.data() + static_cast<size_t>(propertyRow[row]) * MassPropertyTable::NbColumns,
+                     sizeof(float) * MassPropertyTable::NbColumns);
+        }
+        labels.subtreeHash[row] = hash.Value();
+    }
+
+    // Pre-order: every descendant of a row comes after it, so a reverse sweep
+    // folds finished subtrees into their parents
+    for (size_t row = nbRows; row-- > 1;) {
+        const size_t parent = static_cast<size_t>(labels.parent[row]);
+        labels.subtreeHash[parent] = ContentHash::Combine(labels.subtreeHash[parent], labels.subtreeHash[row]);
+    }
+}
+
+bool ReadPreviousExport(const std::string& hdf5File, StringHeap& strings, PreviousExport& previous) {
+    std::error_code ec;
+    if (!std::filesystem::exists(hdf5File, ec)) return false;
+
+    try {
+        H5::H5File file(hdf5File, H5F_ACC_RDONLY);
+        if (!file.nameExists("/labels/subtree_hash") || !file.nameExists("/strings")) return false;
+
+        H5::Group labelGroup = file.openGroup("/labels");
+        // Sharded exports map their labels virtually and cannot grow in place
+        if (labelGroup.openDataSet("parent").getCreatePlist().getLayout() == H5D_VIRTUAL) return false;
+        previous.subtreeHash = ReadColumn<uint64_t>(labelGroup, "subtree_hash", H5::PredType::NATIVE_UINT64);
+        previous.parent = ReadColumn<int32_t>(labelGroup, "parent", H5::PredType::NATIVE_INT32);
+
+        previous.hasProperties = file.nameExists("/PropertiesLabel");
+        if (previous.hasProperties) {
+            H5::Group rootGroup = file.openGroup("/");
+            previous.propertyLabel = ReadColumn<int32_t>(rootGroup, "PropertiesLabel", H5::PredType::NATIVE_INT32);
+        }
+
+        strings.Read(file.openGroup("/strings"));
+        previous.nbStrings = strings.Size();
+        previous.nbStringBytes = strings.Bytes().size();
+    } catch (H5::Exception&) {
+        return false;
+    }
+    return true;
+}
+
+size_t UpdateExport(H5::H5File& file, const PreviousExport& previous, const LabelTable& labels,
+                    const StringHeap& strings, const MassPropertyTable* properties) {
+    // A row is unchanged when it sits at the same position under the same
+    // parent with the same subtree hash; its whole subtree is then skipped
+    std::vector<RowRange> dirty;
+    std::vector<bool> rowDirty(labels.Size(), false);
+    const size_t nbRows = labels.Size();
+    for (size_t row = 0; row < nbRows;) {
+        const bool same = row < previous.subtreeHash.size() &&
+                          previous.subtreeHash[row] == labels.subtreeHash[row] &&
+                          previous.parent[row] == labels.parent[row];
+        if (!same) {
+            AddRow(dirty, row);
+            rowDirty[row] = true;
+            ++row;
+            continue;
+        }
+        const int32_t depth = labels.depth[row];
+        for (++row; row < nbRows && labels.depth[row] > depth; ++row) {
+        }
+    }
+
+    H5::Group labelGroup = file.openGroup("/labels");
+    WriteRanges(labelGroup.openDataSet("parent"), labels.parent, 1, dirty, H5::PredType::NATIVE_INT32);
+    WriteRanges(labelGroup.openDataSet("tag"), labels.tag, 1, dirty, H5::PredType::NATIVE_INT32);
+    WriteRanges(labelGroup.openDataSet("depth"), labels.depth, 1, dirty, H5::PredType::NATIVE_INT32);
+    WriteRanges(labelGroup.openDataSet("name"), labels.name, 1, dirty, H5::PredType::NATIVE_INT32);
+    WriteRanges(labelGroup.openDataSet("subtree_hash"), labels.subtreeHash, 1, dirty, H5::PredType::NATIVE_UINT64);
+
+    // The heap was seeded from the file, so only new strings need appending
+    if (strings.Size() > previous.nbStrings) {
+        H5::Group stringGroup = file.openGroup("/strings");
+        const std::vector<uint64_t>& offsets = strings.Offsets();
+        WriteRanges(stringGroup.openDataSet("offsets"), offsets, 1,
+                    {{previous.nbStrings + 1, offsets.size()}}, H5::PredType::NATIVE_UINT64);
+
+        const std::string& bytes = strings.Bytes();
+        std::vector<uint8_t> data(bytes.begin(), bytes.end());
+        WriteRanges(stringGroup.openDataSet("data"), data, 1,
+                    {{previous.nbStringBytes, data.size()}}, H5::PredType::NATIVE_UINT8);
+    }
+
+    if (properties && previous.hasProperties) {
+        std::vector<RowRange> dirtyProperties;
+        for (size_t i = 0; i < properties->Size(); ++i) {
+            const int32_t row = properties->labelRow[i];
+            if (i >= previous.propertyLabel.size() || previous.propertyLabel[i] != row || rowDirty[static_cast<size_t>(row)]) {
+                AddRow(dirtyProperties, i);
+            }
+        }
+        H5::Group rootGroup = file.openGroup("/");
+        WriteRanges(rootGroup.openDataSet("Properties"), properties->values, MassPropertyTable::NbColumns,
+                    dirtyProperties, H5::PredType::NATIVE_FLOAT);
+        WriteRanges(rootGroup.openDataSet("PropertiesLabel"), properties->labelRow, 1,
+                    dirtyProperties, H5::PredType::NATIVE_INT32);
+    }
+
+    size_t written = 0;
+    for (const RowRange& range : dirty) {
+        written += range.end - range.begin;
+    }
+    return written;
+}
@@ -0,0 +1,39 @@
+#ifndef INCREMENTALEXPORT_2D8F4B61_C7A3_4E95_B0D2_6A1E5F9C3B47
+#define INCREMENTALEXPORT_2D8F4B61_C7A3_4E95_B0D2_6A1E5F9C3B47
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+#include "MassProperties.h"
+#include "StringHeap.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fill labels.subtreeHash: each row hashes its tag, name and mass properties
+// together with the hashes of its children, so equal hashes mean equal subtrees.
+void ComputeSubtreeHashes(LabelTable& labels, const StringHeap& strings, const MassPropertyTable* properties);
+
+// Columns of a previous flat export needed to diff against a new one.
+struct PreviousExport {
+    std::vector<uint64_t> subtreeHash;
+    std::vector<int32_t> parent;
+    std::vector<int32_t> propertyLabel; // empty when the file has no Properties table
+    bool hasProperties = false;
+    size_t nbStrings = 0;
+    uint64_t nbStringBytes = 0;
+};
+
+// Load the diff columns of hdf5File and seed strings with its string heap so
+// existing names keep their ids. Returns false when the file is missing or was
+// not written by a flat export with subtree hashes. Caller holds Hdf5Mutex().
+bool ReadPreviousExport(const std::string& hdf5File, StringHeap& strings, PreviousExport& previous);
+
+// Rewrite only the rows of file whose subtree hash or position changed,
+// resizing the extensible tables to the new row counts. Returns the number of
+// label rows written.
+size_t UpdateExport(H5::H5File& file, const PreviousExport& previous, const LabelTable& labels,
+                    const StringHeap& strings, const MassPropertyTable* properties);
+
+#endif /* INCREMENTALEXPORT_2D8F4B61_C7A3_4E95_B0D2_6A1E5F9C3B47 */
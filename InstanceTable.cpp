@@ -0,0 +1,58 @@
+#include "InstanceTable.h"
+
+#include <TopLoc_Location.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+#include "H5Columns.h"
+
+#include <algorithm>
+
+void AppendPlacement(const gp_Trsf& trsf, std::vector<double>& values) {
+    for (int r = 1; r <= 3; ++r) {
+        for (int c = 1; c <= 4; ++c) {
+            values.push_back(trsf.Value(r, c));
+        }
+    }
+}
+
+InstanceTable BuildInstanceTable(const LabelTable& labels) {
+    InstanceTable table;
+    if (labels.Size() == 0) return table;
+
+    // XCAF keeps every prototype directly under the shapes label (row 0), so
+    // the tag identifies it among the rows of depth 1
+    int32_t maxTag = 0;
+    for (size_t row = 1; row < labels.Size(); ++row) {
+        if (labels.parent[row] == 0) maxTag = std::max(maxTag, labels.tag[row]);
+    }
+    std::vector<int32_t> topLevelRow(static_cast<size_t>(maxTag) + 1, -1);
+    for (size_t row = 1; row < labels.Size(); ++row) {
+        if (labels.parent[row] == 0) topLevelRow[static_cast<size_t>(labels.tag[row])] = static_cast<int32_t>(row);
+    }
+
+    const TDF_Label& root = labels.label[0];
+    for (size_t row = 1; row < labels.Size(); ++row) {
+        const TDF_Label& label = labels.label[row];
+        if (!XCAFDoc_ShapeTool::IsReference(label)) continue;
+
+        int32_t prototype = -1;
+        TDF_Label referred;
+        if (XCAFDoc_ShapeTool::GetReferredShape(label, referred) && referred.Father().IsEqual(root) &&
+            referred.Tag() <= maxTag) {
+            prototype = topLevelRow[static_cast<size_t>(referred.Tag())];
+        }
+        table.label.push_back(static_cast<int32_t>(row));
+        table.prototype.push_back(prototype);
+
+        table.location.push_back(XCAFDoc_ShapeTool::GetLocation(label).Transformation());
+        AppendPlacement(table.location.back(), table.placement);
+    }
+    return table;
+}
+
+void WriteInstanceTable(H5::Group& group, const InstanceTable& table, const H5WriterSettings& settings) {
+    WriteInt32Column(group, "label", table.label, settings);
+    WriteInt32Column(group, "prototype", table.prototype, settings);
+    WriteColumn(group, "placement", table.placement, H5::PredType::IEEE_F64LE, H5::PredType::NATIVE_DOUBLE,
+                settings, InstanceTable::NbColumns);
+}
@@ -0,0 +1,37 @@
+#ifndef INSTANCETABLE_B5E1C7A2_3F94_4D08_8A6B_E29D4C1F7053
+#define INSTANCETABLE_B5E1C7A2_3F94_4D08_8A6B_E29D4C1F7053
+
+#include <gp_Trsf.hxx>
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+
+#include <cstdint>
+#include <vector>
+
+// Assembly components (XCAFDoc_ShapeTool::IsReference labels) as compact rows
+// pointing at their shared prototype. The prototype's attributes and
+// geometry data are written once, on its own label row; every occurrence of
+// it costs one instance row.
+struct InstanceTable {
+    static constexpr int NbColumns = 12; // 3x4 row-major [R|t] placement
+
+    std::vector<int32_t> label;     // row of the component label
+    std::vector<int32_t> prototype; // row of the referred shape label, -1 when unresolved
+    std::vector<double> placement;  // label.size() x NbColumns, component location in its assembly
+    std::vector<gp_Trsf> location;  // the same placement for composing transforms, not written
+
+    size_t Size() const { return label.size(); }
+};
+
+// Append trsf as one NbColumns row of values.
+void AppendPlacement(const gp_Trsf& trsf, std::vector<double>& values);
+
+// Collect one row per reference label of labels.
+InstanceTable BuildInstanceTable(const LabelTable& labels);
+
+// Write the label, prototype and (N,12) placement datasets into group.
+void WriteInstanceTable(H5::Group& group, const InstanceTable& table, const H5WriterSettings& settings);
+
+#endif /* INSTANCETABLE_B5E1C7A2_3F94_4D08_8A6B_E29D4C1F7053 */
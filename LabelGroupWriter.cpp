@@ -0,0 +1,133 @@
+#include "LabelGroupWriter.h"
+
+#include <TDataStd_Name.hxx>
+#include <TDF_ChildIterator.hxx>
+
+#include <H5Cpp.h>
+
+#include "SpscQueue.h"
+#include "StepToH5Converter.h"
+
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t QueueCapacity = 4096;
+constexpr size_t BatchSize = 512; // records written per Hdf5Mutex acquisition
+
+// Consumer side: owns the file and every HDF5 handle.
+class GroupSink {
+public:
+    explicit GroupSink(const std::string& hdf5File) : myFileName(hdf5File) {}
+
+    void Run(SpscQueue<LabelGroupRecord>& queue) {
+        std::vector<LabelGroupRecord> batch;
+        batch.reserve(BatchSize);
+        while (queue.PopBatch(batch, BatchSize)) {
+            if (myFailed) continue; // keep draining so the producer never blocks
+
+            std::lock_guard<std::mutex> lock(Hdf5Mutex());
+            try {
+                if (!myFile) {
+                    Open();
+                }
+                for (const LabelGroupRecord& record : batch) {
+                    Write(record);
+                }
+            } catch (H5::Exception& e) {
+                std::cerr << "HDF5 Error: " << myFileName << ": " << e.getCDetailMsg() << "\n";
+                myFailed = true;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(Hdf5Mutex());
+        try {
+            myStack.clear();
+            if (!myFile && !myFailed) {
+                Open(); // empty tree
+            }
+            if (myFile) {
+                myFile->close();
+            }
+        } catch (H5::Exception& e) {
+            std::cerr << "HDF5 Error: " << myFileName << ": " << e.getCDetailMsg() << "\n";
+            myFailed = true;
+        }
+        myNameType.reset();
+        myFile.reset();
+    }
+
+    bool Failed() const { return myFailed; }
+    int64_t Groups() const { return myGroups; }
+
+private:
+    // Every HDF5 object is created and released on the writer thread
+    void Open() {
+        myFile.emplace(myFileName, H5F_ACC_TRUNC);
+        // One variable-length UTF-8 string type shared by every name attribute
+        myNameType.emplace(H5::PredType::C_S1, H5T_VARIABLE);
+        myNameType->setCset(H5T_CSET_UTF8);
+    }
+
+    void Write(const LabelGroupRecord& record) {
+        // Close the groups of finished subtrees
+        myStack.resize(static_cast<size_t>(record.depth));
+        H5::Group group = record.depth == 0
+            ? myFile->createGroup("/properties")
+            : myStack.back().createGroup("label_" + std::to_string(record.tag));
+        if (record.hasName) {
+            const char* name = record.name.c_str();
+            group.createAttribute("name", *myNameType, H5::DataSpace()).write(*myNameType, &name);
+        }
+        myStack.push_back(group);
+        ++myGroups;
+    }
+
+    std::string myFileName;
+    std::optional<H5::H5File> myFile;
+    std::optional<H5::StrType> myNameType;
+    std::vector<H5::Group> myStack; // open group of each depth on the current path
+    bool myFailed = false;
+    int64_t myGroups = 0;
+};
+
+// Producer side: the recursion of the original exporter, which lists every
+// descendant (not only direct children) under each label's group.
+void EmitLabel(const TDF_Label& label, int32_t depth, SpscQueue<LabelGroupRecord>& queue) {
+    LabelGroupRecord record;
+    record.depth = depth;
+    record.tag = label.Tag();
+
+    Handle(TDataStd_Name) nameAttr;
+    if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
+        const TCollection_ExtendedString& extStr = nameAttr->Get();
+        record.name.resize(static_cast<size_t>(extStr.LengthOfCString()) + 1);
+        Standard_PCharacter buffer = record.name.data();
+        record.name.resize(static_cast<size_t>(extStr.ToUTF8CString(buffer)));
+        record.hasName = true;
+    }
+    queue.Push(std::move(record));
+
+    for (TDF_ChildIterator it(label, Standard_True); it.More(); it.Next()) {
+        EmitLabel(it.Value(), depth + 1, queue);
+    }
+}
+
+} // namespace
+
+int64_t WriteLabelGroups(const TDF_Label& root, const std::string& hdf5File) {
+    SpscQueue<LabelGroupRecord> queue(QueueCapacity);
+    GroupSink sink(hdf5File);
+    std::thread writer([&] { sink.Run(queue); });
+
+    if (!root.IsNull()) {
+        EmitLabel(root, 0, queue);
+    }
+    queue.Close();
+    writer.join();
+    return sink.Failed() ? -1 : sink.Groups();
+}
@@ -0,0 +1,25 @@
+#ifndef LABELGROUPWRITER_8D3B6F19_C42E_4A75_B1E9_0F6A7C5D2E83
+#define LABELGROUPWRITER_8D3B6F19_C42E_4A75_B1E9_0F6A7C5D2E83
+
+#include <TDF_Label.hxx>
+
+#include <cstdint>
+#include <string>
+
+// One group of the legacy layout, as produced by the label walk.
+// Records arrive in depth-first order: a record of depth d is a child of the
+// latest record of depth d - 1. Depth 0 is the /properties group itself.
+struct LabelGroupRecord {
+    int32_t depth = 0;
+    int32_t tag = 0;
+    bool hasName = false;
+    std::string name; // UTF-8
+};
+
+// Write the legacy group-per-label layout of the tree under root to hdf5File.
+// The calling thread walks the labels while a writer thread, the only one
+// touching the file, drains the records and creates the groups. Returns the
+// number of groups written, or -1 on an HDF5 error (reported on std::cerr).
+int64_t WriteLabelGroups(const TDF_Label& root, const std::string& hdf5File);
+
+#endif /* LABELGROUPWRITER_8D3B6F19_C42E_4A75_B1E9_0F6A7C5D2E83 */
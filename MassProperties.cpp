@@ -0,0 +1,100 @@
+#include "MassProperties.h"
+
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD_Parallel.hxx>
+#include <TopoDS_Shape.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+#include "H5Columns.h"
+
+namespace {
+
+bool HasMassProperties(const TopoDS_Shape& shape) {
+    switch (shape.ShapeType()) {
+        case TopAbs_COMPOUND:
+        case TopAbs_COMPSOLID:
+        case TopAbs_SOLID:
+        case TopAbs_SHELL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct MassPropertyFunctor {
+    const std::vector<TopoDS_Shape>& shapes;
+    std::vector<float>& values;
+    std::vector<Message_ProgressRange>& ranges; // one per shape, closed when it is done
+
+    void operator()(int index) const {
+        Message_ProgressRange& range = ranges[static_cast<size_t>(index)];
+        if (range.UserBreak()) return;
+        const TopoDS_Shape& shape = shapes[static_cast<size_t>(index)];
+        GProp_GProps surface;
+        BRepGProp::SurfaceProperties(shape, surface);
+
+        float* row = values.data() + static_cast<size_t>(index) * MassPropertyTable::NbColumns;
+        row[1] = static_cast<float>(surface.Mass());
+
+        // Shells have no volume; their centroid is the centroid of the surface
+        gp_Pnt centroid = surface.CentreOfMass();
+        if (shape.ShapeType() != TopAbs_SHELL) {
+            GProp_GProps volume;
+            BRepGProp::VolumeProperties(shape, volume);
+            row[0] = static_cast<float>(volume.Mass());
+            if (volume.Mass() > 0.0) {
+                centroid = volume.CentreOfMass();
+            }
+        }
+        row[2] = static_cast<float>(centroid.X());
+        row[3] = static_cast<float>(centroid.Y());
+        row[4] = static_cast<float>(centroid.Z());
+        range.Close();
+    }
+};
+
+} // namespace
+
+MassPropertyTable ComputeMassProperties(const LabelTable& labels, const Message_ProgressRange& progress) {
+    MassPropertyTable table;
+
+    // Gather shapes serially; only the geometry evaluation runs in parallel
+    std::vector<TopoDS_Shape> shapes;
+    for (size_t row = 0; row < labels.Size(); ++row) {
+        const TDF_Label& label = labels.label[row];
+        if (!XCAFDoc_ShapeTool::IsSimpleShape(label) || XCAFDoc_ShapeTool::IsReference(label)) continue;
+
+        TopoDS_Shape shape = XCAFDoc_ShapeTool::GetShape(label);
+        if (shape.IsNull() || !HasMassProperties(shape)) continue;
+
+        table.labelRow.push_back(static_cast<int32_t>(row));
+        shapes.push_back(shape);
+    }
+
+    // Ranges are handed out serially; closing them from the workers is thread-safe
+    Message_ProgressScope scope(progress, "properties", static_cast<double>(shapes.size()));
+    std::vector<Message_ProgressRange> ranges;
+    ranges.reserve(shapes.size());
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        ranges.push_back(scope.Next());
+    }
+
+    table.values.assign(shapes.size() * MassPropertyTable::NbColumns, 0.0f);
+    OSD_Parallel::For(0, static_cast<int>(shapes.size()), MassPropertyFunctor{shapes, table.values, ranges});
+    return table;
+}
+
+void WriteMassProperties(H5::Group& group, const MassPropertyTable& table, const H5WriterSettings& settings) {
+    H5AppendWriter<float> writer(group, "Properties", H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT,
+                                 MassPropertyTable::NbColumns, settings);
+    writer.Append(table.values.data(), table.Size());
+    H5::DataSet& properties = writer.Close();
+
+    H5::StrType strType(H5::PredType::C_S1, H5T_VARIABLE);
+    const char* columns = "volume,area,cx,cy,cz";
+    properties.createAttribute("columns", strType, H5::DataSpace()).write(strType, &columns);
+
+    WriteInt32Column(group, "PropertiesLabel", table.labelRow, settings);
+}
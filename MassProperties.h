@@ -0,0 +1,31 @@
+#ifndef MASSPROPERTIES_0507550E_5E5E_4533_B4A0_490B0FCE1E6E
+#define MASSPROPERTIES_0507550E_5E5E_4533_B4A0_490B0FCE1E6E
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+
+#include <Message_ProgressRange.hxx>
+
+#include <cstdint>
+#include <vector>
+
+// Volume, area and centroid of every solid, shell and compound shape label.
+struct MassPropertyTable {
+    static constexpr int NbColumns = 5; // volume, area, cx, cy, cz
+
+    std::vector<int32_t> labelRow; // row in the label table
+    std::vector<float> values;     // labelRow.size() x NbColumns
+
+    size_t Size() const { return labelRow.size(); }
+};
+
+// Evaluate BRepGProp for the shapes of labels, one shape per task on the OCCT thread pool.
+// Shapes not yet started when progress is cancelled keep zero values.
+MassPropertyTable ComputeMassProperties(const LabelTable& labels,
+                                        const Message_ProgressRange& progress = Message_ProgressRange());
+
+// Write the (N,5) "Properties" dataset and its "PropertiesLabel" row index into group.
+void WriteMassProperties(H5::Group& group, const MassPropertyTable& table, const H5WriterSettings& settings);
+
+#endif /* MASSPROPERTIES_0507550E_5E5E_4533_B4A0_490B0FCE1E6E */
@@ -0,0 +1,120 @@
+#include "MembershipTable.h"
+
+#include <TCollection_HAsciiString.hxx>
+#include <TDataStd_TreeNode.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <XCAFDoc.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_LayerTool.hxx>
+#include <XCAFDoc_MaterialTool.hxx>
+
+#include "H5Columns.h"
+
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// (label row, set id) pairs in row order
+using MembershipPairs = std::vector<std::pair<int32_t, int32_t>>;
+
+// Set labels are the direct children of one XCAF section, so the tag is unique
+std::unordered_map<int32_t, int32_t> IndexByTag(const TDF_LabelSequence& setLabels) {
+    std::unordered_map<int32_t, int32_t> index;
+    for (int i = 1; i <= setLabels.Length(); ++i) {
+        index.emplace(setLabels.Value(i).Tag(), i - 1);
+    }
+    return index;
+}
+
+void BuildCsr(MembershipTable& table, const MembershipPairs& pairs, size_t nbRows) {
+    table.labelOffset.assign(nbRows + 1, 0);
+    table.memberOffset.assign(table.Size() + 1, 0);
+    for (const auto& [row, set] : pairs) {
+        ++table.labelOffset[static_cast<size_t>(row) + 1];
+        ++table.memberOffset[static_cast<size_t>(set) + 1];
+    }
+    for (size_t row = 0; row < nbRows; ++row) {
+        table.labelOffset[row + 1] += table.labelOffset[row];
+    }
+    for (size_t set = 0; set < table.Size(); ++set) {
+        table.memberOffset[set + 1] += table.memberOffset[set];
+    }
+
+    // Pairs arrive in row order, so both directions fill in sorted order
+    table.labelSets.resize(pairs.size());
+    table.members.resize(pairs.size());
+    std::vector<uint64_t> fill(table.memberOffset.begin(), table.memberOffset.end() - 1);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        table.labelSets[i] = pairs[i].second;
+        table.members[static_cast<size_t>(fill[static_cast<size_t>(pairs[i].second)]++)] = pairs[i].first;
+    }
+}
+
+} // namespace
+
+MembershipTable BuildLayerTable(const LabelTable& labels, StringHeap& strings) {
+    MembershipTable table;
+    if (labels.Size() == 0) return table;
+
+    Handle(XCAFDoc_LayerTool) layerTool = XCAFDoc_DocumentTool::LayerTool(labels.label[0]);
+    TDF_LabelSequence layerLabels;
+    layerTool->GetLayerLabels(layerLabels);
+    for (int i = 1; i <= layerLabels.Length(); ++i) {
+        TCollection_ExtendedString name;
+        layerTool->GetLayer(layerLabels.Value(i), name);
+        table.name.push_back(strings.AddExtended(name));
+    }
+
+    const std::unordered_map<int32_t, int32_t> layerOfTag = IndexByTag(layerLabels);
+    MembershipPairs pairs;
+    for (size_t row = 0; row < labels.Size(); ++row) {
+        TDF_LabelSequence layers;
+        if (!layerTool->GetLayers(labels.label[row], layers)) continue;
+        for (int i = 1; i <= layers.Length(); ++i) {
+            auto found = layerOfTag.find(layers.Value(i).Tag());
+            if (found != layerOfTag.end()) pairs.emplace_back(static_cast<int32_t>(row), found->second);
+        }
+    }
+    BuildCsr(table, pairs, labels.Size());
+    return table;
+}
+
+MembershipTable BuildMaterialTable(const LabelTable& labels, StringHeap& strings) {
+    MembershipTable table;
+    if (labels.Size() == 0) return table;
+
+    Handle(XCAFDoc_MaterialTool) materialTool = XCAFDoc_DocumentTool::MaterialTool(labels.label[0]);
+    TDF_LabelSequence materialLabels;
+    materialTool->GetMaterialLabels(materialLabels);
+    for (int i = 1; i <= materialLabels.Length(); ++i) {
+        Handle(TCollection_HAsciiString) name, description, densityName, densityValueType;
+        Standard_Real density = 0.0;
+        XCAFDoc_MaterialTool::GetMaterial(materialLabels.Value(i), name, description, density,
+                                          densityName, densityValueType);
+        table.name.push_back(name.IsNull() ? -1 : strings.Add(name->ToCString()));
+        table.density.push_back(density);
+    }
+
+    const std::unordered_map<int32_t, int32_t> materialOfTag = IndexByTag(materialLabels);
+    MembershipPairs pairs;
+    for (size_t row = 0; row < labels.Size(); ++row) {
+        Handle(TDataStd_TreeNode) node;
+        if (!labels.label[row].FindAttribute(XCAFDoc::MaterialRefGUID(), node) || !node->HasFather()) continue;
+        auto found = materialOfTag.find(node->Father()->Label().Tag());
+        if (found != materialOfTag.end()) pairs.emplace_back(static_cast<int32_t>(row), found->second);
+    }
+    BuildCsr(table, pairs, labels.Size());
+    return table;
+}
+
+void WriteMembershipTable(H5::Group& group, const MembershipTable& table, const H5WriterSettings& settings) {
+    WriteInt32Column(group, "name", table.name, settings);
+    if (!table.density.empty()) {
+        WriteColumn(group, "density", table.density, H5::PredType::IEEE_F64LE, H5::PredType::NATIVE_DOUBLE, settings);
+    }
+    WriteColumn(group, "member_offsets", table.memberOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteInt32Column(group, "members", table.members, settings);
+    WriteColumn(group, "label_offsets", table.labelOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteInt32Column(group, "label_sets", table.labelSets, settings);
+}
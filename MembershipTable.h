@@ -0,0 +1,37 @@
+#ifndef MEMBERSHIPTABLE_1F6B3D8A_E52C_4A97_8B04_C7D2E9A51F36
+#define MEMBERSHIPTABLE_1F6B3D8A_E52C_4A97_8B04_C7D2E9A51F36
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+#include "StringHeap.h"
+
+#include <cstdint>
+#include <vector>
+
+// Named sets of label rows (XCAF layers or materials) with the membership
+// stored twice in CSR form: the label rows of set s are
+// members[memberOffset[s] .. memberOffset[s+1]), the sets of label row r are
+// labelSets[labelOffset[r] .. labelOffset[r+1]).
+struct MembershipTable {
+    std::vector<int32_t> name;          // string heap id per set
+    std::vector<double> density;        // per set, materials only
+    std::vector<uint64_t> memberOffset; // set count + 1 entries
+    std::vector<int32_t> members;       // label rows
+    std::vector<uint64_t> labelOffset;  // label count + 1 entries
+    std::vector<int32_t> labelSets;     // set ids
+
+    size_t Size() const { return name.size(); }
+};
+
+// Layers of XCAFDoc_LayerTool and the label rows assigned to them.
+MembershipTable BuildLayerTable(const LabelTable& labels, StringHeap& strings);
+
+// Materials of XCAFDoc_MaterialTool and the label rows referring to them
+// through their XCAFDoc::MaterialRefGUID tree node.
+MembershipTable BuildMaterialTable(const LabelTable& labels, StringHeap& strings);
+
+// Write name, the two CSR structures and, when present, density into group.
+void WriteMembershipTable(H5::Group& group, const MembershipTable& table, const H5WriterSettings& settings);
+
+#endif /* MEMBERSHIPTABLE_1F6B3D8A_E52C_4A97_8B04_C7D2E9A51F36 */
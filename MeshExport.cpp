@@ -0,0 +1,167 @@
+#include "MeshExport.h"
+
+#include <BRepLib_ToolTriangulatedShape.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <OSD_Parallel.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+#include "H5Columns.h"
+
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+struct MeshCountFunctor {
+    const std::vector<TopoDS_Shape>& shapes;
+    std::vector<uint64_t>& nbVertices;
+    std::vector<uint64_t>& nbTriangles;
+
+    void operator()(int index) const {
+        const size_t i = static_cast<size_t>(index);
+        for (TopExp_Explorer exp(shapes[i], TopAbs_FACE); exp.More(); exp.Next()) {
+            TopLoc_Location loc;
+            const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(TopoDS::Face(exp.Current()), loc);
+            if (triangulation.IsNull()) continue;
+            nbVertices[i] += static_cast<uint64_t>(triangulation->NbNodes());
+            nbTriangles[i] += static_cast<uint64_t>(triangulation->NbTriangles());
+        }
+    }
+};
+
+// Prototypes placed by several shapes share their face triangulations, so
+// normals are computed once per triangulation before the fill pass reads them
+struct NormalFunctor {
+    const std::vector<std::pair<TopoDS_Face, Handle(Poly_Triangulation)>>& faces;
+
+    void operator()(int index) const {
+        const auto& [face, triangulation] = faces[static_cast<size_t>(index)];
+        BRepLib_ToolTriangulatedShape::ComputeNormals(face, triangulation);
+    }
+};
+
+// Each task writes the disjoint ranges reserved for its shape by the count pass
+struct MeshFillFunctor {
+    const std::vector<TopoDS_Shape>& shapes;
+    MeshTable& table;
+
+    void operator()(int index) const {
+        const size_t i = static_cast<size_t>(index);
+        const uint64_t firstVertex = table.vertexOffset[i];
+        uint64_t vertex = firstVertex;
+        uint64_t triangle = table.triangleOffset[i];
+        for (TopExp_Explorer exp(shapes[i], TopAbs_FACE); exp.More(); exp.Next()) {
+            const TopoDS_Face& face = TopoDS::Face(exp.Current());
+            TopLoc_Location loc;
+            const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, loc);
+            if (triangulation.IsNull()) continue;
+
+            // Reversed faces flip both the winding and the normals
+            const gp_Trsf& trsf = loc.Transformation();
+            const bool reversed = face.Orientation() == TopAbs_REVERSED;
+            const uint32_t base = static_cast<uint32_t>(vertex - firstVertex);
+            for (int n = 1; n <= triangulation->NbNodes(); ++n, ++vertex) {
+                const gp_Pnt point = triangulation->Node(n).Transformed(trsf);
+                gp_Dir normal = triangulation->Normal(n).Transformed(trsf);
+                if (reversed) normal.Reverse();
+
+                float* v = table.vertices.data() + vertex * 3;
+                v[0] = static_cast<float>(point.X());
+                v[1] = static_cast<float>(point.Y());
+                v[2] = static_cast<float>(point.Z());
+                float* nv = table.normals.data() + vertex * 3;
+                nv[0] = static_cast<float>(normal.X());
+                nv[1] = static_cast<float>(normal.Y());
+                nv[2] = static_cast<float>(normal.Z());
+            }
+            for (int t = 1; t <= triangulation->NbTriangles(); ++t, ++triangle) {
+                int n1 = 0, n2 = 0, n3 = 0;
+                triangulation->Triangle(t).Get(n1, n2, n3);
+                if (reversed) std::swap(n2, n3);
+
+                uint32_t* tv = table.triangles.data() + triangle * 3;
+                tv[0] = base + static_cast<uint32_t>(n1 - 1);
+                tv[1] = base + static_cast<uint32_t>(n2 - 1);
+                tv[2] = base + static_cast<uint32_t>(n3 - 1);
+            }
+        }
+    }
+};
+
+} // namespace
+
+MeshTable ComputeMeshes(const LabelTable& labels, double linearDeflection, double angularDeflection,
+                        const Message_ProgressRange& progress) {
+    MeshTable table;
+
+    // Prototypes sit directly under the shapes label; components only place them
+    std::vector<TopoDS_Shape> shapes;
+    BRep_Builder builder;
+    TopoDS_Compound all;
+    builder.MakeCompound(all);
+    for (size_t row = 1; row < labels.Size(); ++row) {
+        const TDF_Label& label = labels.label[row];
+        if (labels.parent[row] != 0 || !XCAFDoc_ShapeTool::IsSimpleShape(label)) continue;
+
+        TopoDS_Shape shape = XCAFDoc_ShapeTool::GetShape(label);
+        if (shape.IsNull()) continue;
+
+        table.labelRow.push_back(static_cast<int32_t>(row));
+        shapes.push_back(shape);
+        builder.Add(all, shape);
+    }
+
+    // One mesher over everything so its face-level parallelism spans all shapes
+    IMeshTools_Parameters parameters;
+    parameters.Deflection = linearDeflection;
+    parameters.Angle = angularDeflection;
+    parameters.Relative = Standard_False;
+    parameters.InParallel = Standard_True;
+    BRepMesh_IncrementalMesh mesher(all, parameters, progress);
+
+    // Normals follow the surface; the fill pass flips them for reversed faces
+    std::vector<std::pair<TopoDS_Face, Handle(Poly_Triangulation)>> withoutNormals;
+    std::unordered_set<const Poly_Triangulation*> seen;
+    for (const TopoDS_Shape& shape : shapes) {
+        for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
+            TopLoc_Location loc;
+            const TopoDS_Face& face = TopoDS::Face(exp.Current());
+            const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, loc);
+            if (triangulation.IsNull() || triangulation->HasNormals() || !seen.insert(triangulation.get()).second) continue;
+            withoutNormals.emplace_back(TopoDS::Face(face.Oriented(TopAbs_FORWARD)), triangulation);
+        }
+    }
+    OSD_Parallel::For(0, static_cast<int>(withoutNormals.size()), NormalFunctor{withoutNormals});
+
+    std::vector<uint64_t> nbVertices(shapes.size(), 0);
+    std::vector<uint64_t> nbTriangles(shapes.size(), 0);
+    OSD_Parallel::For(0, static_cast<int>(shapes.size()), MeshCountFunctor{shapes, nbVertices, nbTriangles});
+
+    table.vertexOffset.assign(shapes.size() + 1, 0);
+    table.triangleOffset.assign(shapes.size() + 1, 0);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        table.vertexOffset[i + 1] = table.vertexOffset[i] + nbVertices[i];
+        table.triangleOffset[i + 1] = table.triangleOffset[i] + nbTriangles[i];
+    }
+    table.vertices.resize(static_cast<size_t>(table.vertexOffset.back()) * 3);
+    table.normals.resize(static_cast<size_t>(table.vertexOffset.back()) * 3);
+    table.triangles.resize(static_cast<size_t>(table.triangleOffset.back()) * 3);
+    OSD_Parallel::For(0, static_cast<int>(shapes.size()), MeshFillFunctor{shapes, table});
+    return table;
+}
+
+void WriteMeshTable(H5::Group& group, const MeshTable& table, const H5WriterSettings& settings) {
+    WriteColumn(group, "vertices", table.vertices, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT, settings, 3);
+    WriteColumn(group, "normals", table.normals, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT, settings, 3);
+    WriteColumn(group, "triangles", table.triangles, H5::PredType::STD_U32LE, H5::PredType::NATIVE_UINT32, settings, 3);
+    WriteColumn(group, "vertex_offsets", table.vertexOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteColumn(group, "triangle_offsets", table.triangleOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteInt32Column(group, "label", table.labelRow, settings);
+}
@@ -0,0 +1,39 @@
+#ifndef MESHEXPORT_3A6D9E14_8C2B_4F57_A0E3_5B1F7D49C268
+#define MESHEXPORT_3A6D9E14_8C2B_4F57_A0E3_5B1F7D49C268
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+
+#include <Message_ProgressRange.hxx>
+
+#include <cstdint>
+#include <vector>
+
+// Triangle meshes of every prototype shape, concatenated into contiguous
+// arrays. The vertices of shape i are rows [vertexOffset[i], vertexOffset[i+1])
+// and its triangles rows [triangleOffset[i], triangleOffset[i+1]); triangle
+// indices count from the shape's first vertex.
+struct MeshTable {
+    std::vector<int32_t> labelRow;        // row in the label table
+    std::vector<uint64_t> vertexOffset;   // labelRow.size() + 1 entries
+    std::vector<uint64_t> triangleOffset; // labelRow.size() + 1 entries
+    std::vector<float> vertices;          // x, y, z per vertex
+    std::vector<float> normals;           // unit normal per vertex
+    std::vector<uint32_t> triangles;      // three vertex indices per triangle, counter-clockwise
+
+    size_t Size() const { return labelRow.size(); }
+};
+
+// Mesh the top-level simple shapes of labels with one BRepMesh_IncrementalMesh
+// run in parallel mode, then gather the face triangulations of each shape on
+// the OCCT thread pool. The mesher advances progress and stops, leaving the
+// remaining faces untriangulated, when progress is cancelled.
+MeshTable ComputeMeshes(const LabelTable& labels, double linearDeflection, double angularDeflection,
+                        const Message_ProgressRange& progress = Message_ProgressRange());
+
+// Write vertices, normals, triangles, vertex_offsets, triangle_offsets and
+// label into group.
+void WriteMeshTable(H5::Group& group, const MeshTable& table, const H5WriterSettings& settings);
+
+#endif /* MESHEXPORT_3A6D9E14_8C2B_4F57_A0E3_5B1F7D49C268 */
@@ -0,0 +1,72 @@
+#include "NameIndex.h"
+
+#include "H5Columns.h"
+#include "NameNormalization.h"
+
+#include <algorithm>
+#include <numeric>
+
+NameIndex BuildNameIndex(const LabelTable& labels, const StringHeap& strings) {
+    NameIndex index;
+
+    // Normalize each distinct string once; many rows share a name
+    std::vector<int32_t> usedIds;
+    std::vector<bool> used(strings.Size(), false);
+    for (const int32_t id : labels.name) {
+        if (id >= 0 && !used[static_cast<size_t>(id)]) {
+            used[static_cast<size_t>(id)] = true;
+            usedIds.push_back(id);
+        }
+    }
+    std::vector<std::string> normalized(usedIds.size());
+    for (size_t i = 0; i < usedIds.size(); ++i) {
+        normalized[i] = NormalizeName(strings.Get(usedIds[i]));
+    }
+
+    std::vector<size_t> order(usedIds.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return normalized[a] < normalized[b]; });
+
+    // Distinct keys in sorted order; names differing only in case share one
+    std::vector<int32_t> keyOfString(strings.Size(), -1);
+    index.keyOffset.push_back(0);
+    const std::string* lastKey = nullptr;
+    for (const size_t i : order) {
+        if (normalized[i].empty()) continue;
+        if (!lastKey || *lastKey != normalized[i]) {
+            index.keyBytes += normalized[i];
+            index.keyOffset.push_back(index.keyBytes.size());
+            lastKey = &normalized[i];
+        }
+        keyOfString[static_cast<size_t>(usedIds[i])] = static_cast<int32_t>(index.Size() - 1);
+    }
+
+    // Rows per key, filled in row order
+    index.rowOffset.assign(index.Size() + 1, 0);
+    for (const int32_t id : labels.name) {
+        if (id >= 0 && keyOfString[static_cast<size_t>(id)] >= 0) {
+            ++index.rowOffset[static_cast<size_t>(keyOfString[static_cast<size_t>(id)]) + 1];
+        }
+    }
+    for (size_t k = 0; k < index.Size(); ++k) {
+        index.rowOffset[k + 1] += index.rowOffset[k];
+    }
+    index.rows.resize(static_cast<size_t>(index.rowOffset.back()));
+    std::vector<uint64_t> fill(index.rowOffset.begin(), index.rowOffset.end() - 1);
+    for (size_t row = 0; row < labels.Size(); ++row) {
+        const int32_t id = labels.name[row];
+        if (id < 0 || keyOfString[static_cast<size_t>(id)] < 0) continue;
+        index.rows[static_cast<size_t>(fill[static_cast<size_t>(keyOfString[static_cast<size_t>(id)])]++)] =
+            static_cast<int32_t>(row);
+    }
+    return index;
+}
+
+void WriteNameIndex(H5::Group& group, const NameIndex& index, const H5WriterSettings& settings) {
+    H5AppendWriter<char> data(group, "key_data", H5::PredType::STD_U8LE, H5::PredType::NATIVE_UINT8, 1, settings);
+    data.Append(index.keyBytes.data(), index.keyBytes.size());
+    data.Close();
+    WriteColumn(group, "key_offsets", index.keyOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteColumn(group, "row_offsets", index.rowOffset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    WriteInt32Column(group, "rows", index.rows, settings);
+}
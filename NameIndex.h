@@ -0,0 +1,33 @@
+#ifndef NAMEINDEX_D17A4E93_2C5B_4F80_9E36_B4A8C1D75F02
+#define NAMEINDEX_D17A4E93_2C5B_4F80_9E36_B4A8C1D75F02
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+#include "StringHeap.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Distinct normalized label names (see NameNormalization.h) in byte order,
+// each with the label rows carrying it. Key k occupies
+// keyBytes[keyOffset[k] .. keyOffset[k+1]) and its rows are
+// rows[rowOffset[k] .. rowOffset[k+1]), so the rows of a run of keys, such as
+// all keys sharing a prefix, are contiguous too.
+struct NameIndex {
+    std::string keyBytes;
+    std::vector<uint64_t> keyOffset; // key count + 1 entries
+    std::vector<uint64_t> rowOffset; // key count + 1 entries
+    std::vector<int32_t> rows;       // ascending within each key
+
+    size_t Size() const { return keyOffset.empty() ? 0 : keyOffset.size() - 1; }
+};
+
+// Normalize every distinct name of labels once and sort the keys.
+NameIndex BuildNameIndex(const LabelTable& labels, const StringHeap& strings);
+
+// Write key_data, key_offsets, row_offsets and rows into group.
+void WriteNameIndex(H5::Group& group, const NameIndex& index, const H5WriterSettings& settings);
+
+#endif /* NAMEINDEX_D17A4E93_2C5B_4F80_9E36_B4A8C1D75F02 */
@@ -0,0 +1,28 @@
+#ifndef NAMENORMALIZATION_6B8E1D42_F39A_4C57_A2D6_08E4B7C3F195
+#define NAMENORMALIZATION_6B8E1D42_F39A_4C57_A2D6_08E4B7C3F195
+
+#include <string>
+#include <string_view>
+
+// Key of the name index, shared by the exporter and the reader: ASCII
+// letters lowercased, leading and trailing whitespace dropped and inner runs
+// of whitespace collapsed to one space. Other UTF-8 bytes are kept as is.
+inline std::string NormalizeName(std::string_view name) {
+    std::string key;
+    key.reserve(name.size());
+    bool pendingSpace = false;
+    for (const char c : name) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    return key;
+}
+
+#endif /* NAMENORMALIZATION_6B8E1D42_F39A_4C57_A2D6_08E4B7C3F195 */
@@ -0,0 +1,72 @@
+#include "OccurrenceTable.h"
+
+#include "H5Columns.h"
+
+namespace {
+
+struct Expansion {
+    const InstanceTable& instances;
+    std::vector<int32_t> firstComponent; // CSR over label rows: instances placed in each assembly
+    std::vector<int32_t> components;
+    std::vector<bool> onPath;            // guards against cyclic references
+    OccurrenceTable& table;
+
+    void Visit(int32_t prototype, int32_t parent, int32_t instance, const gp_Trsf& world) {
+        const int32_t row = static_cast<int32_t>(table.Size());
+        table.parent.push_back(parent);
+        table.instance.push_back(instance);
+        table.prototype.push_back(prototype);
+        AppendPlacement(world, table.world);
+        table.worldTrsf.push_back(world);
+
+        const size_t p = static_cast<size_t>(prototype);
+        onPath[p] = true;
+        for (int32_t k = firstComponent[p]; k < firstComponent[p + 1]; ++k) {
+            const int32_t child = components[static_cast<size_t>(k)];
+            const int32_t childPrototype = instances.prototype[static_cast<size_t>(child)];
+            if (childPrototype < 0 || onPath[static_cast<size_t>(childPrototype)]) continue;
+            Visit(childPrototype, row, child, world.Multiplied(instances.location[static_cast<size_t>(child)]));
+        }
+        onPath[p] = false;
+    }
+};
+
+} // namespace
+
+OccurrenceTable BuildOccurrenceTable(const LabelTable& labels, const InstanceTable& instances) {
+    OccurrenceTable table;
+    const size_t nbRows = labels.Size();
+
+    // Components are direct children of their assembly's label
+    Expansion expansion{instances, std::vector<int32_t>(nbRows + 1, 0), {}, std::vector<bool>(nbRows, false), table};
+    std::vector<bool> referenced(nbRows, false);
+    for (size_t i = 0; i < instances.Size(); ++i) {
+        ++expansion.firstComponent[static_cast<size_t>(labels.parent[static_cast<size_t>(instances.label[i])]) + 1];
+        if (instances.prototype[i] >= 0) referenced[static_cast<size_t>(instances.prototype[i])] = true;
+    }
+    for (size_t row = 0; row < nbRows; ++row) {
+        expansion.firstComponent[row + 1] += expansion.firstComponent[row];
+    }
+    expansion.components.resize(instances.Size());
+    std::vector<int32_t> fill(expansion.firstComponent.begin(), expansion.firstComponent.end() - 1);
+    for (size_t i = 0; i < instances.Size(); ++i) {
+        const size_t assembly = static_cast<size_t>(labels.parent[static_cast<size_t>(instances.label[i])]);
+        expansion.components[static_cast<size_t>(fill[assembly]++)] = static_cast<int32_t>(i);
+    }
+
+    const gp_Trsf identity;
+    for (size_t row = 1; row < nbRows; ++row) {
+        if (labels.parent[row] == 0 && !referenced[row]) {
+            expansion.Visit(static_cast<int32_t>(row), -1, -1, identity);
+        }
+    }
+    return table;
+}
+
+void WriteOccurrenceTable(H5::Group& group, const OccurrenceTable& table, const H5WriterSettings& settings) {
+    WriteInt32Column(group, "parent", table.parent, settings);
+    WriteInt32Column(group, "instance", table.instance, settings);
+    WriteInt32Column(group, "prototype", table.prototype, settings);
+    WriteColumn(group, "world", table.world, H5::PredType::IEEE_F64LE, H5::PredType::NATIVE_DOUBLE,
+                settings, OccurrenceTable::NbColumns);
+}
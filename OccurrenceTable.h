@@ -0,0 +1,34 @@
+#ifndef OCCURRENCETABLE_E4A19C52_7B3D_4F06_9D8E_1C5B2A7F3E64
+#define OCCURRENCETABLE_E4A19C52_7B3D_4F06_9D8E_1C5B2A7F3E64
+
+#include <H5Cpp.h>
+
+#include "InstanceTable.h"
+#include "StepLabelTable.h"
+
+#include <cstdint>
+#include <vector>
+
+// The assembly graph expanded into one row per placed shape, in pre-order
+// from the free shapes down, with the world transform of each occurrence.
+struct OccurrenceTable {
+    static constexpr int NbColumns = InstanceTable::NbColumns;
+
+    std::vector<int32_t> parent;    // occurrence row of the enclosing assembly, -1 for free shapes
+    std::vector<int32_t> instance;  // instance row placing this occurrence, -1 for free shapes
+    std::vector<int32_t> prototype; // label row of the placed shape
+    std::vector<double> world;      // parent.size() x NbColumns, product of every placement above
+    std::vector<gp_Trsf> worldTrsf; // the same transforms for later geometry passes, not written
+
+    size_t Size() const { return parent.size(); }
+};
+
+// Expand instances from every unreferenced top-level shape. Each world
+// transform is the parent's composed transform times the local placement,
+// so the whole table costs one gp_Trsf product per row.
+OccurrenceTable BuildOccurrenceTable(const LabelTable& labels, const InstanceTable& instances);
+
+// Write the parent, instance, prototype and (N,12) world datasets into group.
+void WriteOccurrenceTable(H5::Group& group, const OccurrenceTable& table, const H5WriterSettings& settings);
+
+#endif /* OCCURRENCETABLE_E4A19C52_7B3D_4F06_9D8E_1C5B2A7F3E64 */
@@ -0,0 +1,333 @@
+#include "ShardedExport.h"
+
+#include "H5Columns.h"
+
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// A shard travels from WriteShards to its writer process over a stream
+// socket: a word of content flags, then every column as its value
+// count followed by the raw values, in the order RunShardWriter reads them.
+constexpr uint64_t theHasSubtreeHash = 1;
+constexpr uint64_t theHasProperties = 2;
+constexpr uint64_t theHasMesh = 4;
+
+bool SendAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        // A writer that died turns into EPIPE rather than SIGPIPE
+        const ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool ReceiveAll(int fd, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t received = ::read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+// Rows [first, first + nbRows) of values, `columns` values per row
+template <typename T>
+bool SendRows(int fd, const std::vector<T>& values, uint64_t first, uint64_t nbRows, uint64_t columns = 1) {
+    const uint64_t count = nbRows * columns;
+    return SendAll(fd, &count, sizeof(count)) && SendAll(fd, values.data() + first * columns, count * sizeof(T));
+}
+
+template <typename T>
+bool ReceiveColumn(int fd, std::vector<T>& values) {
+    uint64_t count = 0;
+    if (!ReceiveAll(fd, &count, sizeof(count))) return false;
+    values.resize(static_cast<size_t>(count));
+    return ReceiveAll(fd, values.data(), values.size() * sizeof(T));
+}
+
+bool SendShard(int fd, const ShardPlan& plan, size_t k, const LabelTable& labels,
+               const MassPropertyTable* properties, const MeshTable* meshes) {
+    const uint64_t contents = (labels.subtreeHash.empty() ? 0 : theHasSubtreeHash) |
+                              (properties ? theHasProperties : 0) | (meshes ? theHasMesh : 0);
+    if (!SendAll(fd, &contents, sizeof(contents))) return false;
+
+    const uint64_t row = static_cast<uint64_t>(plan.labelBegin[k]);
+    const uint64_t rows = static_cast<uint64_t>(plan.labelBegin[k + 1]) - row;
+    bool sent = SendRows(fd, labels.parent, row, rows) && SendRows(fd, labels.tag, row, rows) &&
+                SendRows(fd, labels.depth, row, rows) && SendRows(fd, labels.name, row, rows);
+    if (sent && !labels.subtreeHash.empty()) {
+        sent = SendRows(fd, labels.subtreeHash, row, rows);
+    }
+    if (sent && properties) {
+        const uint64_t first = plan.propertyBegin[k];
+        const uint64_t count = plan.propertyBegin[k + 1] - first;
+        sent = SendRows(fd, properties->values, first, count, MassPropertyTable::NbColumns) &&
+               SendRows(fd, properties->labelRow, first, count);
+    }
+    if (sent && meshes) {
+        const uint64_t vertex = meshes->vertexOffset[plan.meshBegin[k]];
+        const uint64_t vertices = meshes->vertexOffset[plan.meshBegin[k + 1]] - vertex;
+        const uint64_t triangle = meshes->triangleOffset[plan.meshBegin[k]];
+        const uint64_t triangles = meshes->triangleOffset[plan.meshBegin[k + 1]] - triangle;
+        sent = SendRows(fd, meshes->vertices, vertex, vertices, 3) && SendRows(fd, meshes->normals, vertex, vertices, 3) &&
+               SendRows(fd, meshes->triangles, triangle, triangles, 3);
+    }
+    return sent;
+}
+
+// Start this executable again as the writer of shardFile, reading the shard
+// from input. posix_spawn only execs in the child, so unlike fork it is safe
+// while other threads hold locks.
+pid_t SpawnShardWriter(const std::string& shardFile, const H5WriterSettings& settings, int input) {
+    const std::string chunkRows = std::to_string(settings.chunkRows);
+    const std::string deflateLevel = std::to_string(settings.deflateLevel);
+    char* const argv[] = {const_cast<char*>("step2hdf5"), const_cast<char*>(theShardWriterFlag),
+                          const_cast<char*>(shardFile.c_str()), const_cast<char*>(chunkRows.c_str()),
+                          const_cast<char*>(deflateLevel.c_str()), nullptr};
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, input, STDIN_FILENO);
+    pid_t pid = -1;
+    const int error = ::posix_spawn(&pid, "/proc/self/exe", &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return error == 0 ? pid : -1;
+}
+
+// Dataset `name` of group mapping rows [begin[k], begin[k + 1]) onto
+// sourcePath of shard k. Shard names are relative, which HDF5 resolves
+// against the master file's directory.
+void WriteVirtualColumn(H5::Group& group, const char* name, const char* sourcePath, const H5::PredType& fileType,
+                        const std::vector<std::string>& shards, const std::vector<uint64_t>& begin,
+                        hsize_t columns = 1) {
+    const int rank = columns == 1 ? 1 : 2;
+    hsize_t dims[2] = {begin.back(), columns};
+    H5::DataSpace virtualSpace(rank, dims);
+
+    H5::DSetCreatPropList props;
+    for (size_t k = 0; k + 1 < begin.size(); ++k) {
+        hsize_t offset[2] = {begin[k], 0};
+        hsize_t count[2] = {begin[k + 1] - begin[k], columns};
+        if (count[0] == 0) continue;
+        virtualSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        props.setVirtual(virtualSpace, shards[k].c_str(), sourcePath, H5::DataSpace(rank, count));
+    }
+    virtualSpace.selectAll();
+    group.createDataSet(name, fileType, virtualSpace, props);
+}
+
+} // namespace
+
+ShardPlan PlanShards(const LabelTable& labels, const MassPropertyTable* properties, const MeshTable* meshes,
+                     int nbShards) {
+    ShardPlan plan;
+    const size_t nbRows = labels.Size();
+    const size_t wanted = static_cast<size_t>(std::max(1, nbShards));
+    plan.labelBegin.push_back(0);
+    for (size_t row = 1; row < nbRows && plan.labelBegin.size() < wanted; ++row) {
+        if (labels.parent[row] == 0 && row * wanted >= plan.labelBegin.size() * nbRows) {
+            plan.labelBegin.push_back(static_cast<int32_t>(row));
+        }
+    }
+    plan.labelBegin.push_back(static_cast<int32_t>(nbRows));
+
+    // Both tables list their labels in row order
+    for (const int32_t row : plan.labelBegin) {
+        if (properties) {
+            plan.propertyBegin.push_back(static_cast<size_t>(
+                std::lower_bound(properties->labelRow.begin(), properties->labelRow.end(), row) -
+                properties->labelRow.begin()));
+        }
+        if (meshes) {
+            plan.meshBegin.push_back(static_cast<size_t>(
+                std::lower_bound(meshes->labelRow.begin(), meshes->labelRow.end(), row) - meshes->labelRow.begin()));
+        }
+    }
+    return plan;
+}
+
+std::string ShardFileName(const std::string& hdf5File, size_t shard) {
+    return hdf5File + ".shard" + std::to_string(shard) + ".h5";
+}
+
+void RemoveStaleShards(const std::string& hdf5File, size_t first) {
+    // Exports number their shards from 0 without gaps, so the stale ones end
+    // at the first missing index; no directory listing is needed
+    for (size_t shard = first;; ++shard) {
+        const std::string shardFile = ShardFileName(hdf5File, shard);
+        std::error_code ec;
+        if (!std::filesystem::remove(shardFile, ec)) {
+            if (ec) {
+                std::cerr << "Failed to remove stale shard: " << shardFile << "\n";
+            }
+            break;
+        }
+    }
+}
+
+bool WriteShards(const std::string& hdf5File, const ShardPlan& plan, const LabelTable& labels,
+                 const MassPropertyTable* properties, const MeshTable* meshes, const H5WriterSettings& settings) {
+    RemoveStaleShards(hdf5File, plan.Size());
+
+    // Each writer compresses its shard while the next one is being sent
+    std::vector<pid_t> children;
+    bool ok = true;
+    for (size_t k = 0; k < plan.Size() && ok; ++k) {
+        const std::string shardFile = ShardFileName(hdf5File, k);
+        int channel[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, channel) != 0) {
+            std::cerr << "Failed to open a channel to the writer of " << shardFile << "\n";
+            ok = false;
+            break;
+        }
+        const pid_t pid = SpawnShardWriter(shardFile, settings, channel[1]);
+        ::close(channel[1]);
+        if (pid < 0) {
+            std::cerr << "Failed to start the writer of " << shardFile << "\n";
+            ok = false;
+        } else {
+            children.push_back(pid);
+            ok = SendShard(channel[0], plan, k, labels, properties, meshes);
+            if (!ok) {
+                std::cerr << "Failed to send the rows of " << shardFile << "\n";
+            }
+        }
+        ::close(channel[0]);
+    }
+
+    for (const pid_t pid : children) {
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    return ok;
+}
+
+int RunShardWriter(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: step2hdf5 " << theShardWriterFlag << " shard.h5 chunk-rows deflate-level\n";
+        return 2;
+    }
+    const std::string shardFile = argv[0];
+    H5WriterSettings settings;
+    settings.chunkRows = std::strtoull(argv[1], nullptr, 10);
+    settings.deflateLevel = std::atoi(argv[2]);
+
+    uint64_t contents = 0;
+    std::vector<int32_t> parent, tag, depth, name, propertyLabel;
+    std::vector<uint64_t> subtreeHash;
+    std::vector<float> properties, vertices, normals;
+    std::vector<uint32_t> triangles;
+    const int input = STDIN_FILENO;
+    const bool received =
+        ReceiveAll(input, &contents, sizeof(contents)) && ReceiveColumn(input, parent) && ReceiveColumn(input, tag) &&
+        ReceiveColumn(input, depth) && ReceiveColumn(input, name) &&
+        (!(contents & theHasSubtreeHash) || ReceiveColumn(input, subtreeHash)) &&
+        (!(contents & theHasProperties) || (ReceiveColumn(input, properties) && ReceiveColumn(input, propertyLabel))) &&
+        (!(contents & theHasMesh) ||
+         (ReceiveColumn(input, vertices) && ReceiveColumn(input, normals) && ReceiveColumn(input, triangles)));
+    if (!received) {
+        std::cerr << "Incomplete shard rows for: " << shardFile << "\n";
+        return 1;
+    }
+
+    try {
+        H5::H5File file(shardFile, H5F_ACC_TRUNC);
+        H5::Group labelGroup = file.createGroup("/labels");
+        WriteInt32Column(labelGroup, "parent", parent, settings);
+        WriteInt32Column(labelGroup, "tag", tag, settings);
+        WriteInt32Column(labelGroup, "depth", depth, settings);
+        WriteInt32Column(labelGroup, "name", name, settings);
+        if (contents & theHasSubtreeHash) {
+            WriteColumn(labelGroup, "subtree_hash", subtreeHash, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64,
+                        settings);
+        }
+        if (contents & theHasProperties) {
+            H5::Group rootGroup = file.openGroup("/");
+            WriteColumn(rootGroup, "Properties", properties, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT,
+                        settings, MassPropertyTable::NbColumns);
+            WriteInt32Column(rootGroup, "PropertiesLabel", propertyLabel, settings);
+        }
+        if (contents & theHasMesh) {
+            H5::Group meshGroup = file.createGroup("/mesh");
+            WriteColumn(meshGroup, "vertices", vertices, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT, settings, 3);
+            WriteColumn(meshGroup, "normals", normals, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT, settings, 3);
+            WriteColumn(meshGroup, "triangles", triangles, H5::PredType::STD_U32LE, H5::PredType::NATIVE_UINT32,
+                        settings, 3);
+        }
+        file.close();
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << shardFile << ": " << e.getCDetailMsg() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+void WriteShardViews(H5::H5File& file, const std::string& hdf5File, const ShardPlan& plan, const LabelTable& labels,
+                     const MassPropertyTable* properties, const MeshTable* meshes, const H5WriterSettings& settings) {
+    std::vector<std::string> shards;
+    for (size_t k = 0; k < plan.Size(); ++k) {
+        shards.push_back(std::filesystem::path(ShardFileName(hdf5File, k)).filename().string());
+    }
+
+    const std::vector<uint64_t> labelBegin(plan.labelBegin.begin(), plan.labelBegin.end());
+    H5::Group labelGroup = file.createGroup("/labels");
+    WriteVirtualColumn(labelGroup, "parent", "/labels/parent", H5::PredType::STD_I32LE, shards, labelBegin);
+    WriteVirtualColumn(labelGroup, "tag", "/labels/tag", H5::PredType::STD_I32LE, shards, labelBegin);
+    WriteVirtualColumn(labelGroup, "depth", "/labels/depth", H5::PredType::STD_I32LE, shards, labelBegin);
+    WriteVirtualColumn(labelGroup, "name", "/labels/name", H5::PredType::STD_I32LE, shards, labelBegin);
+    if (!labels.subtreeHash.empty()) {
+        WriteVirtualColumn(labelGroup, "subtree_hash", "/labels/subtree_hash", H5::PredType::STD_U64LE, shards,
+                           labelBegin);
+    }
+    H5::StrType strType(H5::PredType::C_S1, H5T_VARIABLE);
+    const char* rootEntry = labels.rootEntry.c_str();
+    labelGroup.createAttribute("root_entry", strType, H5::DataSpace()).write(strType, &rootEntry);
+
+    if (properties) {
+        const std::vector<uint64_t> propertyBegin(plan.propertyBegin.begin(), plan.propertyBegin.end());
+        H5::Group rootGroup = file.openGroup("/");
+        WriteVirtualColumn(rootGroup, "Properties", "/Properties", H5::PredType::IEEE_F32LE, shards, propertyBegin,
+                           MassPropertyTable::NbColumns);
+        const char* columns = "volume,area,cx,cy,cz";
+        rootGroup.openDataSet("Properties").createAttribute("columns", strType, H5::DataSpace()).write(strType, &columns);
+        WriteVirtualColumn(rootGroup, "PropertiesLabel", "/PropertiesLabel", H5::PredType::STD_I32LE, shards,
+                           propertyBegin);
+    }
+
+    if (meshes) {
+        std::vector<uint64_t> vertexBegin, triangleBegin;
+        for (const size_t row : plan.meshBegin) {
+            vertexBegin.push_back(meshes->vertexOffset[row]);
+            triangleBegin.push_back(meshes->triangleOffset[row]);
+        }
+        // The per-shape index is small and stays in the master file
+        H5::Group meshGroup = file.createGroup("/mesh");
+        WriteVirtualColumn(meshGroup, "vertices", "/mesh/vertices", H5::PredType::IEEE_F32LE, shards, vertexBegin, 3);
+        WriteVirtualColumn(meshGroup, "normals", "/mesh/normals", H5::PredType::IEEE_F32LE, shards, vertexBegin, 3);
+        WriteVirtualColumn(meshGroup, "triangles", "/mesh/triangles", H5::PredType::STD_U32LE, shards, triangleBegin, 3);
+        WriteColumn(meshGroup, "vertex_offsets", meshes->vertexOffset, H5::PredType::STD_U64LE,
+                    H5::PredType::NATIVE_UINT64, settings);
+        WriteColumn(meshGroup, "triangle_offsets", meshes->triangleOffset, H5::PredType::STD_U64LE,
+                    H5::PredType::NATIVE_UINT64, settings);
+        WriteInt32Column(meshGroup, "label", meshes->labelRow, settings);
+    }
+}
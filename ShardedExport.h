@@ -0,0 +1,60 @@
+#ifndef SHARDEDEXPORT_3F8A2C64_1E7B_4D95_A0C3_5B9D6E2F7814
+#define SHARDEDEXPORT_3F8A2C64_1E7B_4D95_A0C3_5B9D6E2F7814
+
+#include <H5Cpp.h>
+
+#include "MassProperties.h"
+#include "MeshExport.h"
+#include "StepLabelTable.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Split of a flat export into shard files. Shard k holds label rows
+// [labelBegin[k], labelBegin[k + 1]) together with the property and mesh
+// rows of those labels. Cuts fall on top-level shape labels only, so every
+// free shape and every prototype it places stays whole.
+struct ShardPlan {
+    std::vector<int32_t> labelBegin;   // Size() + 1 entries
+    std::vector<size_t> propertyBegin; // Size() + 1 entries, rows of the MassPropertyTable
+    std::vector<size_t> meshBegin;     // Size() + 1 entries, rows of the MeshTable
+
+    size_t Size() const { return labelBegin.size() - 1; }
+};
+
+// Balance about labels.Size() / nbShards rows per shard. Fewer shards are
+// planned when there are not enough top-level labels to cut at.
+ShardPlan PlanShards(const LabelTable& labels, const MassPropertyTable* properties, const MeshTable* meshes,
+                     int nbShards);
+
+// "<hdf5File>.shard<k>.h5", next to the master file.
+std::string ShardFileName(const std::string& hdf5File, size_t shard);
+
+// Write every shard from a writer process of its own, so the shards are
+// written and compressed in parallel despite HDF5's process-wide lock. The
+// writers are this executable started again with posix_spawn as
+// "<theShardWriterFlag> <shard file> <chunk rows> <deflate level>"; each
+// reads its rows from a socket on stdin. Shard files of an earlier export
+// with more shards are removed. Call before the master file is opened.
+bool WriteShards(const std::string& hdf5File, const ShardPlan& plan, const LabelTable& labels,
+                 const MassPropertyTable* properties, const MeshTable* meshes, const H5WriterSettings& settings);
+
+// Delete "<hdf5File>.shard<k>.h5" for k = first, first + 1, ... up to the
+// first one that does not exist. Costs one unlink when there is none.
+void RemoveStaleShards(const std::string& hdf5File, size_t first);
+
+// First argument that makes main() a shard writer
+inline constexpr const char* theShardWriterFlag = "--write-shard";
+
+// Main of a writer process: argv holds the arguments after
+// theShardWriterFlag. Returns the process exit status.
+int RunShardWriter(int argc, char** argv);
+
+// Create /labels, Properties/PropertiesLabel and the /mesh arrays of the
+// master file as virtual datasets over the shards, so readers see the same
+// tables as in an unsharded export.
+void WriteShardViews(H5::H5File& file, const std::string& hdf5File, const ShardPlan& plan, const LabelTable& labels,
+                     const MassPropertyTable* properties, const MeshTable* meshes, const H5WriterSettings& settings);
+
+#endif /* SHARDEDEXPORT_3F8A2C64_1E7B_4D95_A0C3_5B9D6E2F7814 */
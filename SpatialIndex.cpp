@@ -0,0 +1,183 @@
+#include "SpatialIndex.h"
+
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <OSD_Parallel.hxx>
+#include <TopoDS_Shape.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+#include "H5Columns.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+struct ShapeBoxFunctor {
+    const std::vector<TopoDS_Shape>& shapes;
+    std::vector<Bnd_Box>& boxes;
+
+    void operator()(int index) const {
+        BRepBndLib::Add(shapes[static_cast<size_t>(index)], boxes[static_cast<size_t>(index)], Standard_True);
+    }
+};
+
+struct OccurrenceBoxFunctor {
+    const OccurrenceTable& occurrences;
+    const std::vector<int32_t>& boxOfRow;
+    const std::vector<Bnd_Box>& shapeBoxes;
+    std::vector<Bnd_Box>& boxes;
+
+    void operator()(int index) const {
+        const size_t occurrence = static_cast<size_t>(index);
+        const int32_t box = boxOfRow[static_cast<size_t>(occurrences.prototype[occurrence])];
+        if (box >= 0 && !shapeBoxes[static_cast<size_t>(box)].IsVoid()) {
+            boxes[occurrence] = shapeBoxes[static_cast<size_t>(box)].Transformed(occurrences.worldTrsf[occurrence]);
+        }
+    }
+};
+
+// Round outwards so the float box still contains the double one
+void AppendBox(const Bnd_Box& box, std::vector<float>& values) {
+    if (box.IsVoid()) {
+        values.insert(values.end(), {Infinity, Infinity, Infinity, -Infinity, -Infinity, -Infinity});
+        return;
+    }
+    Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+    box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+    for (const Standard_Real v : {xmin, ymin, zmin}) {
+        values.push_back(std::nextafter(static_cast<float>(v), -Infinity));
+    }
+    for (const Standard_Real v : {xmax, ymax, zmax}) {
+        values.push_back(std::nextafter(static_cast<float>(v), Infinity));
+    }
+}
+
+} // namespace
+
+BoundsTable ComputeBounds(const LabelTable& labels, const OccurrenceTable& occurrences) {
+    BoundsTable bounds;
+
+    // Prototypes sit directly under the shapes label, as for the mesh export
+    std::vector<TopoDS_Shape> shapes;
+    std::vector<int32_t> boxOfRow(labels.Size(), -1);
+    for (size_t row = 1; row < labels.Size(); ++row) {
+        const TDF_Label& label = labels.label[row];
+        if (labels.parent[row] != 0 || !XCAFDoc_ShapeTool::IsSimpleShape(label)) continue;
+
+        TopoDS_Shape shape = XCAFDoc_ShapeTool::GetShape(label);
+        if (shape.IsNull()) continue;
+
+        boxOfRow[row] = static_cast<int32_t>(shapes.size());
+        bounds.shapeLabel.push_back(static_cast<int32_t>(row));
+        shapes.push_back(shape);
+    }
+
+    std::vector<Bnd_Box> shapeBoxes(shapes.size());
+    OSD_Parallel::For(0, static_cast<int>(shapes.size()), ShapeBoxFunctor{shapes, shapeBoxes});
+
+    std::vector<Bnd_Box> boxes(occurrences.Size());
+    OSD_Parallel::For(0, static_cast<int>(occurrences.Size()),
+                      OccurrenceBoxFunctor{occurrences, boxOfRow, shapeBoxes, boxes});
+
+    bounds.occurrenceLeaf.resize(occurrences.Size());
+    for (size_t occurrence = 0; occurrence < occurrences.Size(); ++occurrence) {
+        bounds.occurrenceLeaf[occurrence] = !boxes[occurrence].IsVoid();
+    }
+
+    // Pre-order: a reverse sweep grows every assembly box by its finished children
+    for (size_t occurrence = occurrences.Size(); occurrence-- > 0;) {
+        const int32_t parent = occurrences.parent[occurrence];
+        if (parent >= 0) boxes[static_cast<size_t>(parent)].Add(boxes[occurrence]);
+    }
+
+    for (const Bnd_Box& box : shapeBoxes) {
+        AppendBox(box, bounds.shapeBox);
+    }
+    for (const Bnd_Box& box : boxes) {
+        AppendBox(box, bounds.occurrenceBox);
+    }
+    return bounds;
+}
+
+BvhTable BuildBvh(const BoundsTable& bounds) {
+    constexpr int N = BoundsTable::NbColumns;
+    BvhTable bvh;
+    for (size_t occurrence = 0; occurrence < bounds.occurrenceLeaf.size(); ++occurrence) {
+        if (bounds.occurrenceLeaf[occurrence]) bvh.items.push_back(static_cast<int32_t>(occurrence));
+    }
+    if (bvh.items.empty()) return bvh;
+
+    auto box = [&](int32_t item) { return bounds.occurrenceBox.data() + static_cast<size_t>(item) * N; };
+    auto centre = [&](int32_t item, int axis) { return box(item)[axis] + box(item)[axis + 3]; };
+
+    // Children are allocated when their parent is dequeued, so processing the
+    // queue in order lays the nodes out breadth-first
+    struct Pending {
+        int32_t node;
+        int32_t begin;
+        int32_t end;
+    };
+    std::vector<Pending> queue{{0, 0, static_cast<int32_t>(bvh.items.size())}};
+    bvh.nodeFirst.push_back(0);
+    bvh.nodeCount.push_back(0);
+    bvh.nodeBox.resize(N);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const Pending pending = queue[head];
+        float nodeBox[N] = {Infinity, Infinity, Infinity, -Infinity, -Infinity, -Infinity};
+        float centreMin[3] = {Infinity, Infinity, Infinity};
+        float centreMax[3] = {-Infinity, -Infinity, -Infinity};
+        for (int32_t i = pending.begin; i < pending.end; ++i) {
+            const int32_t item = bvh.items[static_cast<size_t>(i)];
+            for (int axis = 0; axis < 3; ++axis) {
+                nodeBox[axis] = std::min(nodeBox[axis], box(item)[axis]);
+                nodeBox[axis + 3] = std::max(nodeBox[axis + 3], box(item)[axis + 3]);
+                centreMin[axis] = std::min(centreMin[axis], centre(item, axis));
+                centreMax[axis] = std::max(centreMax[axis], centre(item, axis));
+            }
+        }
+        std::copy(nodeBox, nodeBox + N, bvh.nodeBox.begin() + static_cast<ptrdiff_t>(pending.node) * N);
+
+        if (pending.end - pending.begin <= BvhTable::LeafSize) {
+            bvh.nodeFirst[static_cast<size_t>(pending.node)] = pending.begin;
+            bvh.nodeCount[static_cast<size_t>(pending.node)] = pending.end - pending.begin;
+            continue;
+        }
+
+        int axis = 0;
+        for (int a = 1; a < 3; ++a) {
+            if (centreMax[a] - centreMin[a] > centreMax[axis] - centreMin[axis]) axis = a;
+        }
+        const int32_t mid = pending.begin + (pending.end - pending.begin) / 2;
+        std::nth_element(bvh.items.begin() + pending.begin, bvh.items.begin() + mid, bvh.items.begin() + pending.end,
+                         [&](int32_t a, int32_t b) { return centre(a, axis) < centre(b, axis); });
+
+        const int32_t left = static_cast<int32_t>(bvh.Size());
+        bvh.nodeFirst[static_cast<size_t>(pending.node)] = left;
+        bvh.nodeFirst.insert(bvh.nodeFirst.end(), {0, 0});
+        bvh.nodeCount.insert(bvh.nodeCount.end(), {0, 0});
+        bvh.nodeBox.resize(bvh.Size() * N);
+        queue.push_back({left, pending.begin, mid});
+        queue.push_back({left + 1, mid, pending.end});
+    }
+    return bvh;
+}
+
+void WriteBounds(H5::Group& group, const BoundsTable& bounds, const H5WriterSettings& settings) {
+    WriteInt32Column(group, "shape_label", bounds.shapeLabel, settings);
+    WriteColumn(group, "shape_box", bounds.shapeBox, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT,
+                settings, BoundsTable::NbColumns);
+    WriteColumn(group, "occurrence_box", bounds.occurrenceBox, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT,
+                settings, BoundsTable::NbColumns);
+}
+
+void WriteBvh(H5::Group& group, const BvhTable& bvh, const H5WriterSettings& settings) {
+    WriteColumn(group, "node_box", bvh.nodeBox, H5::PredType::IEEE_F32LE, H5::PredType::NATIVE_FLOAT,
+                settings, BoundsTable::NbColumns);
+    WriteInt32Column(group, "node_first", bvh.nodeFirst, settings);
+    WriteInt32Column(group, "node_count", bvh.nodeCount, settings);
+    WriteInt32Column(group, "items", bvh.items, settings);
+}
@@ -0,0 +1,50 @@
+#ifndef SPATIALINDEX_72C4A9E1_5D3B_4B86_9F20_E6A1D8C35B47
+#define SPATIALINDEX_72C4A9E1_5D3B_4B86_9F20_E6A1D8C35B47
+
+#include <H5Cpp.h>
+
+#include "OccurrenceTable.h"
+#include "StepLabelTable.h"
+
+#include <cstdint>
+#include <vector>
+
+// Axis-aligned boxes as xmin, ymin, zmin, xmax, ymax, zmax. An empty box has
+// min > max, so it never overlaps anything.
+struct BoundsTable {
+    static constexpr int NbColumns = 6;
+
+    std::vector<int32_t> shapeLabel;   // label row of each prototype shape with geometry
+    std::vector<float> shapeBox;       // shapeLabel.size() x NbColumns, in the shape's own frame
+    std::vector<float> occurrenceBox;  // one world box per occurrence row, assemblies enclose their parts
+    std::vector<bool> occurrenceLeaf;  // occurrence places a shape that has its own geometry, not written
+};
+
+// Bounding volume hierarchy over the leaf occurrences, nodes in breadth-first
+// order. An inner node has count 0 and its children at first and first + 1;
+// a leaf lists items[first .. first + count).
+struct BvhTable {
+    static constexpr int LeafSize = 4;
+
+    std::vector<float> nodeBox;     // BoundsTable::NbColumns per node, node 0 is the root
+    std::vector<int32_t> nodeFirst;
+    std::vector<int32_t> nodeCount;
+    std::vector<int32_t> items;     // occurrence rows
+
+    size_t Size() const { return nodeFirst.size(); }
+};
+
+// Bnd_Box of every prototype shape on the OCCT thread pool, then the world
+// box of every occurrence.
+BoundsTable ComputeBounds(const LabelTable& labels, const OccurrenceTable& occurrences);
+
+// Median split on the longest axis of the item centroids.
+BvhTable BuildBvh(const BoundsTable& bounds);
+
+// Write shape_label, shape_box and occurrence_box into group.
+void WriteBounds(H5::Group& group, const BoundsTable& bounds, const H5WriterSettings& settings);
+
+// Write node_box, node_first, node_count and items into group.
+void WriteBvh(H5::Group& group, const BvhTable& bvh, const H5WriterSettings& settings);
+
+#endif /* SPATIALINDEX_72C4A9E1_5D3B_4B86_9F20_E6A1D8C35B47 */
@@ -0,0 +1,75 @@
+#ifndef SPSCQUEUE_5F7A2C93_1E4B_4D68_9A0C_B83D6E21F54A
+#define SPSCQUEUE_5F7A2C93_1E4B_4D68_9A0C_B83D6E21F54A
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer and one consumer
+// thread. Each side owns one index and only reads the other's; a full or
+// empty queue blocks on the other index through std::atomic::wait.
+template <typename T>
+class SpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mySlots.resize(size);
+        myMask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer: blocks while the queue is full.
+    void Push(T&& value) {
+        const size_t tail = myTail.load(std::memory_order_relaxed);
+        size_t head = myHead.load(std::memory_order_acquire);
+        while (tail - head == mySlots.size()) {
+            myHead.wait(head, std::memory_order_acquire);
+            head = myHead.load(std::memory_order_acquire);
+        }
+        mySlots[tail & myMask] = std::move(value);
+        myTail.store(tail + 1, std::memory_order_release);
+        myTail.notify_one();
+    }
+
+    // Producer: no more Push() calls follow.
+    void Close() {
+        myTail.fetch_or(ClosedBit, std::memory_order_release);
+        myTail.notify_one();
+    }
+
+    // Consumer: replace out with up to maxCount values, blocking until one is
+    // available. Returns false once the queue is closed and drained.
+    bool PopBatch(std::vector<T>& out, size_t maxCount) {
+        out.clear();
+        const size_t head = myHead.load(std::memory_order_relaxed);
+        size_t tail = myTail.load(std::memory_order_acquire);
+        while ((tail & ~ClosedBit) == head) {
+            if (tail & ClosedBit) return false;
+            myTail.wait(tail, std::memory_order_acquire);
+            tail = myTail.load(std::memory_order_acquire);
+        }
+
+        const size_t available = (tail & ~ClosedBit) - head;
+        const size_t count = available < maxCount ? available : maxCount;
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(std::move(mySlots[(head + i) & myMask]));
+        }
+        myHead.store(head + count, std::memory_order_release);
+        myHead.notify_one();
+        return true;
+    }
+
+private:
+    static constexpr size_t ClosedBit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    std::vector<T> mySlots;
+    size_t myMask = 0;
+    alignas(64) std::atomic<size_t> myHead{0}; // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> myTail{0}; // next slot to fill, written by the producer
+};
+
+#endif /* SPSCQUEUE_5F7A2C93_1E4B_4D68_9A0C_B83D6E21F54A */
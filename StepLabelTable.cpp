@@ -0,0 +1,71 @@
+#include "StepLabelTable.h"
+
+#include <Message_ProgressScope.hxx>
+#include <TDataStd_Name.hxx>
+#include <TDF_ChildIterator.hxx>
+#include <TDF_Tool.hxx>
+#include <TCollection_AsciiString.hxx>
+
+#include "H5Columns.h"
+
+namespace {
+
+// Rows between two progress updates
+constexpr int32_t theProgressRows = 1024;
+
+// Returns false once the scope is cancelled
+bool AppendLabel(const TDF_Label& label, int32_t parentRow, int32_t depth,
+                 LabelTable& table, StringHeap& strings, Message_ProgressScope& scope) {
+    const int32_t row = static_cast<int32_t>(table.Size());
+    if (row % theProgressRows == theProgressRows - 1) {
+        scope.Next(theProgressRows);
+        if (!scope.More()) return false;
+    }
+    table.parent.push_back(parentRow);
+    table.tag.push_back(label.Tag());
+    table.depth.push_back(depth);
+    table.label.push_back(label);
+
+    Handle(TDataStd_Name) nameAttr;
+    if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
+        table.name.push_back(strings.AddExtended(nameAttr->Get()));
+    } else {
+        table.name.push_back(-1);
+    }
+
+    // Direct children only; the recursion reaches deeper levels exactly once
+    for (TDF_ChildIterator it(label, Standard_False); it.More(); it.Next()) {
+        if (!AppendLabel(it.Value(), row, depth + 1, table, strings, scope)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+LabelTable BuildLabelTable(const TDF_Label& root, StringHeap& strings, const Message_ProgressRange& progress) {
+    LabelTable table;
+    if (root.IsNull()) return table;
+
+    TCollection_AsciiString entry;
+    TDF_Tool::Entry(root, entry);
+    table.rootEntry = entry.ToCString();
+
+    // The number of labels is not known before the walk
+    Message_ProgressScope scope(progress, "labels", 1.0, Standard_True);
+    AppendLabel(root, -1, 0, table, strings, scope);
+    return table;
+}
+
+void WriteLabelTable(H5::Group& group, const LabelTable& table, const H5WriterSettings& settings) {
+    WriteInt32Column(group, "parent", table.parent, settings);
+    WriteInt32Column(group, "tag", table.tag, settings);
+    WriteInt32Column(group, "depth", table.depth, settings);
+    WriteInt32Column(group, "name", table.name, settings);
+    if (!table.subtreeHash.empty()) {
+        WriteColumn(group, "subtree_hash", table.subtreeHash, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+    }
+
+    H5::StrType strType(H5::PredType::C_S1, H5T_VARIABLE);
+    const char* rootEntry = table.rootEntry.c_str();
+    group.createAttribute("root_entry", strType, H5::DataSpace()).write(strType, &rootEntry);
+}
@@ -0,0 +1,40 @@
+#ifndef STEPLABELTABLE_A81B0139_9AC8_456A_A1AF_7F569FABE839
+#define STEPLABELTABLE_A81B0139_9AC8_456A_A1AF_7F569FABE839
+
+#include <Message_ProgressRange.hxx>
+#include <TDF_Label.hxx>
+
+#include <H5Cpp.h>
+
+#include "StringHeap.h"
+#include "H5AppendWriter.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Flat, columnar view of a TDF label tree.
+// Rows are stored in pre-order, so the subtree of row i is the run of rows
+// following i whose depth is greater than depth[i].
+struct LabelTable {
+    std::vector<int32_t> parent;     // row of the parent label, -1 for the root
+    std::vector<int32_t> tag;        // TDF tag of the label
+    std::vector<int32_t> depth;      // distance from the root row
+    std::vector<int32_t> name;       // string heap id of the name, -1 when unnamed
+    std::string rootEntry;           // entry of row 0, e.g. "0:1:1"
+    std::vector<uint64_t> subtreeHash; // content hash of each row's subtree, written when present
+    std::vector<TDF_Label> label;    // source label of each row, not written
+
+    size_t Size() const { return tag.size(); }
+};
+
+// Walk the label tree under root once and collect one row per label.
+// Names are interned into strings. The walk counts its rows on progress
+// and ends early, with a partial table, when progress is cancelled.
+LabelTable BuildLabelTable(const TDF_Label& root, StringHeap& strings,
+                           const Message_ProgressRange& progress = Message_ProgressRange());
+
+// Write the table as contiguous datasets into group.
+void WriteLabelTable(H5::Group& group, const LabelTable& table, const H5WriterSettings& settings);
+
+#endif /* STEPLABELTABLE_A81B0139_9AC8_456A_A1AF_7F569FABE839 */
@@ -0,0 +1,212 @@
+#include "StepProbe.h"
+
+#include "StepScanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+// One "Meta" row; every string member is NUL terminated. The record of
+// wiki/gem_hdf5_define_data_write.cpp comes first, member for member, and
+// what the header says beyond it follows.
+struct MetaRecord {
+    char Domain[32];  // application protocol
+    char Origin[32];  // file name of the probed path
+    char Mesh[32];    // empty, a probe meshes nothing
+    float NumShapes;  // entity records, -1 without a scan
+    float Version_M;
+    float Version_R;
+    char Path[256];
+    char FileName[128];
+    char TimeStamp[32];
+    char System[128];
+    char Preprocessor[128];
+    char Schema[128];
+    char LengthUnit[16];
+    int64_t NumEntities;
+};
+
+template <size_t N>
+void CopyString(char (&target)[N], const std::string& source) {
+    std::strncpy(target, source.c_str(), N - 1);
+    target[N - 1] = '\0';
+}
+
+template <size_t N>
+void InsertString(H5::CompType& type, const char* name, size_t offset, const char (&)[N]) {
+    H5::StrType strType(H5::PredType::C_S1, N);
+    strType.setStrpad(H5T_STR_NULLTERM);
+    type.insertMember(name, offset, strType);
+}
+
+std::string Upper(std::string_view text) {
+    std::string upper(text);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    return upper;
+}
+
+std::string Lower(std::string_view text) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+}
+
+// Statements of the header, split at ';' outside strings and comments
+std::vector<std::string_view> HeaderStatements(std::string_view header) {
+    std::vector<std::string_view> statements;
+    size_t start = 0;
+    for (size_t i = 0; i < header.size(); ++i) {
+        if (header[i] == '\'') {
+            // A doubled quote closes and reopens the string
+            i = header.find('\'', i + 1);
+            if (i == std::string_view::npos) break;
+        } else if (header.compare(i, 2, "/*") == 0) {
+            const size_t comment = i;
+            i = header.find("*/", i + 2);
+            if (i == std::string_view::npos) break;
+            ++i;
+            // A comment ahead of a statement would hide its type
+            if (header.substr(start, comment - start).find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                start = i + 1;
+            }
+        } else if (header[i] == ';') {
+            statements.push_back(header.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    return statements;
+}
+
+std::string StringParameter(const std::vector<std::string_view>& parameters, size_t i) {
+    std::string text;
+    if (i < parameters.size()) {
+        DecodeStepString(parameters[i], text);
+    }
+    return text;
+}
+
+// Application protocol of a schema name, e.g. AUTOMOTIVE_DESIGN -> AP214
+std::string ApplicationProtocol(const std::string& schema) {
+    const std::string name = Upper(schema.substr(0, schema.find_first_of(" {")));
+    if (name.rfind("CONFIG_CONTROL_DESIGN", 0) == 0) return "AP203";
+    if (name.rfind("AUTOMOTIVE_DESIGN", 0) == 0) return "AP214";
+    // Later editions name their schemas after the protocol, e.g. AP242_MANAGED_MODEL_BASED_...
+    size_t digits = 2;
+    while (digits < name.size() && std::isdigit(static_cast<unsigned char>(name[digits]))) ++digits;
+    return name.rfind("AP", 0) == 0 && digits > 2 ? name.substr(0, digits) : std::string();
+}
+
+// "2;1" -> 2, 1
+void ImplementationLevel(const std::string& level, int& major, int& minor) {
+    const char* end = level.data() + level.size();
+    const char* p = std::from_chars(level.data(), end, major).ptr;
+    if (p < end && *p == ';') {
+        std::from_chars(p + 1, end, minor);
+    }
+}
+
+// Unit symbol of a complex LENGTH_UNIT record, empty when it is not one
+std::string LengthUnit(std::string_view record) {
+    if (record.empty() || record.front() != '(' || record.find("LENGTH_UNIT(") == std::string_view::npos) return {};
+
+    std::vector<std::string_view> parameters;
+    const size_t conversion = record.find("CONVERSION_BASED_UNIT(");
+    if (conversion != std::string_view::npos) {
+        SplitStepParameters(record.substr(conversion), parameters);
+        return Lower(StringParameter(parameters, 0));
+    }
+
+    // SI_UNIT(prefix, name) with enumeration values such as .MILLI.
+    const size_t si = record.find("SI_UNIT(");
+    if (si == std::string_view::npos || !SplitStepParameters(record.substr(si), parameters) || parameters.size() < 2) {
+        return {};
+    }
+    static const char* const thePrefixes[][2] = {{".KILO.", "k"}, {".HECTO.", "h"}, {".DECA.", "da"},
+                                                 {".DECI.", "d"}, {".CENTI.", "c"}, {".MILLI.", "m"},
+                                                 {".MICRO.", "u"}, {".NANO.", "n"}};
+    std::string prefix;
+    for (const auto& entry : thePrefixes) {
+        if (parameters[0] == entry[0]) prefix = entry[1];
+    }
+    return parameters[1] == ".METRE." ? prefix + "m" : Lower(parameters[1]);
+}
+
+} // namespace
+
+bool ProbeStepFile(const std::string& stepFile, bool scan, StepProbe& probe) {
+    StepScanner scanner;
+    if (!scanner.Open(stepFile, !scan)) return false;
+
+    std::vector<std::string_view> parameters;
+    for (const std::string_view statement : HeaderStatements(scanner.Header())) {
+        const std::string_view type = StepTypeName(statement);
+        if (type != "FILE_NAME" && type != "FILE_SCHEMA" && type != "FILE_DESCRIPTION") continue;
+        if (!SplitStepParameters(statement, parameters)) continue;
+
+        if (type == "FILE_NAME") {
+            probe.fileName = StringParameter(parameters, 0);
+            probe.timeStamp = StringParameter(parameters, 1);
+            probe.preprocessor = StringParameter(parameters, 4);
+            probe.system = StringParameter(parameters, 5);
+        } else if (type == "FILE_DESCRIPTION") {
+            ImplementationLevel(StringParameter(parameters, 1), probe.versionMajor, probe.versionMinor);
+        } else if (!parameters.empty()) {
+            // schema_identifiers is a list of strings
+            std::vector<std::string_view> schemas;
+            if (SplitStepParameters(parameters[0], schemas) && !schemas.empty()) {
+                probe.schema = StringParameter(schemas, 0);
+                probe.protocol = ApplicationProtocol(probe.schema);
+            }
+        }
+    }
+
+    if (scan) {
+        probe.nbEntities = static_cast<int64_t>(scanner.Size());
+        for (size_t i = 0; i < scanner.Size() && probe.lengthUnit.empty(); ++i) {
+            probe.lengthUnit = LengthUnit(scanner.Record(i));
+        }
+    }
+    return true;
+}
+
+void WriteStepProbe(H5::Group& group, const StepProbe& probe, const std::string& stepFile) {
+    MetaRecord record{};
+    CopyString(record.Domain, probe.protocol);
+    CopyString(record.Origin, std::filesystem::path(stepFile).filename().string());
+    record.NumShapes = static_cast<float>(probe.nbEntities);
+    record.Version_M = static_cast<float>(probe.versionMajor);
+    record.Version_R = static_cast<float>(probe.versionMinor);
+    CopyString(record.Path, stepFile);
+    CopyString(record.FileName, probe.fileName);
+    CopyString(record.TimeStamp, probe.timeStamp);
+    CopyString(record.System, probe.system);
+    CopyString(record.Preprocessor, probe.preprocessor);
+    CopyString(record.Schema, probe.schema);
+    CopyString(record.LengthUnit, probe.lengthUnit);
+    record.NumEntities = probe.nbEntities;
+
+    H5::CompType type(sizeof(MetaRecord));
+    InsertString(type, "Domain", HOFFSET(MetaRecord, Domain), record.Domain);
+    InsertString(type, "Origin", HOFFSET(MetaRecord, Origin), record.Origin);
+    InsertString(type, "Mesh", HOFFSET(MetaRecord, Mesh), record.Mesh);
+    type.insertMember("NumShapes", HOFFSET(MetaRecord, NumShapes), H5::PredType::NATIVE_FLOAT);
+    type.insertMember("Version_M", HOFFSET(MetaRecord, Version_M), H5::PredType::NATIVE_FLOAT);
+    type.insertMember("Version_R", HOFFSET(MetaRecord, Version_R), H5::PredType::NATIVE_FLOAT);
+    InsertString(type, "Path", HOFFSET(MetaRecord, Path), record.Path);
+    InsertString(type, "FileName", HOFFSET(MetaRecord, FileName), record.FileName);
+    InsertString(type, "TimeStamp", HOFFSET(MetaRecord, TimeStamp), record.TimeStamp);
+    InsertString(type, "System", HOFFSET(MetaRecord, System), record.System);
+    InsertString(type, "Preprocessor", HOFFSET(MetaRecord, Preprocessor), record.Preprocessor);
+    InsertString(type, "Schema", HOFFSET(MetaRecord, Schema), record.Schema);
+    InsertString(type, "LengthUnit", HOFFSET(MetaRecord, LengthUnit), record.LengthUnit);
+    type.insertMember("NumEntities", HOFFSET(MetaRecord, NumEntities), H5::PredType::NATIVE_INT64);
+
+    hsize_t dims[1] = {1};
+    H5::DataSpace space(1, dims);
+    group.createDataSet("Meta", type, space).write(&record, type);
+}
@@ -0,0 +1,38 @@
+#ifndef STEPPROBE_5E9A1C3B_72D4_4F08_B6A1_C4830D2F9E57
+#define STEPPROBE_5E9A1C3B_72D4_4F08_B6A1_C4830D2F9E57
+
+#include <H5Cpp.h>
+
+#include <cstdint>
+#include <string>
+
+// What a STEP file says about itself in its Part 21 HEADER section, for
+// triage before a full conversion. The entity count and length unit need the
+// DATA section and are only filled by a scan.
+struct StepProbe {
+    std::string fileName;     // FILE_NAME.name
+    std::string timeStamp;    // FILE_NAME.time_stamp
+    std::string system;       // FILE_NAME.originating_system
+    std::string preprocessor; // FILE_NAME.preprocessor_version
+    std::string schema;       // first FILE_SCHEMA entry, e.g. "AUTOMOTIVE_DESIGN { 1 2 10303 214 0 1 1 1 }"
+    std::string protocol;     // "AP203", "AP214", "AP242", ... from the schema, empty when not recognized
+    int versionMajor = 0;     // FILE_DESCRIPTION.implementation_level "2;1" -> 2, 1
+    int versionMinor = 0;
+    std::string lengthUnit;   // "mm", "m", "inch", ... of the first LENGTH_UNIT record, scan only
+    int64_t nbEntities = -1;  // entity records, -1 without a scan
+};
+
+// Read the header of stepFile, which maps only its first pages. With scan,
+// index the whole file as well to count its entities and find its length
+// unit. Returns false when stepFile is not a Part 21 file.
+bool ProbeStepFile(const std::string& stepFile, bool scan, StepProbe& probe);
+
+// Write probe as the one-row "Meta" compound dataset of group. It starts
+// with the members of wiki/gem_hdf5_define_data_write.cpp: Domain (the
+// protocol), Origin (the file name of stepFile), an empty Mesh, NumShapes
+// (the entity count) and Version_M/Version_R. Path, the FILE_NAME and
+// FILE_SCHEMA fields, LengthUnit and an integer NumEntities follow.
+// Strings longer than their member are cut.
+void WriteStepProbe(H5::Group& group, const StepProbe& probe, const std::string& stepFile);
+
+#endif /* STEPPROBE_5E9A1C3B_72D4_4F08_B6A1_C4830D2F9E57 */
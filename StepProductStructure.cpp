@@ -0,0 +1,114 @@
+#include "StepProductStructure.h"
+
+#include "H5Columns.h"
+
+#include <unordered_map>
+
+namespace {
+
+bool IsUseful(const std::string& str) {
+    return str.find_last_not_of(" \t\r\n") != std::string::npos;
+}
+
+// Parameters of the record for entity, empty when it is missing or complex
+const std::vector<std::string_view>& Parameters(const StepScanner& scanner, int32_t entity,
+                                                std::vector<std::string_view>& parameters) {
+    const int32_t i = entity < 0 ? -1 : scanner.Find(entity);
+    if (i < 0 || !SplitStepParameters(scanner.Record(static_cast<size_t>(i)), parameters)) {
+        parameters.clear();
+    }
+    return parameters;
+}
+
+} // namespace
+
+bool ReadProductStructure(const std::string& stepFile, StringHeap& strings, ProductStructure& structure) {
+    StepScanner scanner;
+    if (!scanner.Open(stepFile)) {
+        return false;
+    }
+
+    // Same naming rules as STEPCAFControl_Reader::ReadNames; only the
+    // definitions, their formations and products, and NAUOs are decoded
+    const size_t nb = scanner.Size();
+    structure.nbEntities = static_cast<int32_t>(nb);
+    std::unordered_map<int32_t, int32_t> productRows;
+    std::vector<size_t> nauos;
+    std::vector<std::string_view> parameters;
+    std::string id, name;
+    for (size_t i = 0; i < nb; i++) {
+        const std::string_view record = scanner.Record(i);
+        const std::string_view type = StepTypeName(record);
+
+        if (type == "NEXT_ASSEMBLY_USAGE_OCCURRENCE") {
+            nauos.push_back(i);
+            continue;
+        }
+        if (type != "PRODUCT_DEFINITION" && type != "PRODUCT_DEFINITION_WITH_ASSOCIATED_DOCUMENTS") continue;
+
+        const int32_t entity = scanner.Index().entity[i];
+        productRows[entity] = static_cast<int32_t>(structure.products.entity.size());
+        structure.products.entity.push_back(entity);
+
+        // PRODUCT_DEFINITION.formation -> PRODUCT_DEFINITION_FORMATION.of_product -> PRODUCT
+        SplitStepParameters(record, parameters);
+        const int32_t formation = parameters.size() > 2 ? StepReference(parameters[2]) : -1;
+        Parameters(scanner, formation, parameters);
+        const int32_t product = parameters.size() > 2 ? StepReference(parameters[2]) : -1;
+        if (Parameters(scanner, product, parameters).size() < 2) {
+            structure.products.id.push_back(strings.Add(std::string_view()));
+            structure.products.name.push_back(strings.Add(std::string_view()));
+            continue;
+        }
+        DecodeStepString(parameters[0], id);
+        DecodeStepString(parameters[1], name);
+        structure.products.id.push_back(strings.Add(id));
+        structure.products.name.push_back(strings.Add(IsUseful(name) ? name : id));
+    }
+
+    // NAUOs may precede the definitions they link, so resolve them in a second pass
+    auto productRow = [&](std::string_view parameter) -> int32_t {
+        auto found = productRows.find(StepReference(parameter));
+        return found == productRows.end() ? -1 : found->second;
+    };
+    std::string description;
+    for (const size_t i : nauos) {
+        if (!SplitStepParameters(scanner.Record(i), parameters) || parameters.size() < 5) continue;
+        DecodeStepString(parameters[0], id);
+        DecodeStepString(parameters[1], name);
+        const bool hasDescription = DecodeStepString(parameters[2], description);
+
+        structure.usages.entity.push_back(scanner.Index().entity[i]);
+        structure.usages.parent.push_back(productRow(parameters[3]));
+        structure.usages.child.push_back(productRow(parameters[4]));
+        if (hasDescription && IsUseful(description)) structure.usages.name.push_back(strings.Add(description));
+        else if (IsUseful(name)) structure.usages.name.push_back(strings.Add(name));
+        else structure.usages.name.push_back(strings.Add(id));
+    }
+
+    structure.index = scanner.Index();
+    return true;
+}
+
+void WriteProductStructure(H5::Group& group, const ProductStructure& structure, const H5WriterSettings& settings) {
+    H5::Group products = group.createGroup("products");
+    WriteInt32Column(products, "entity", structure.products.entity, settings);
+    WriteInt32Column(products, "id", structure.products.id, settings);
+    WriteInt32Column(products, "name", structure.products.name, settings);
+
+    H5::Group usages = group.createGroup("assembly_usage");
+    WriteInt32Column(usages, "entity", structure.usages.entity, settings);
+    WriteInt32Column(usages, "parent", structure.usages.parent, settings);
+    WriteInt32Column(usages, "child", structure.usages.child, settings);
+    WriteInt32Column(usages, "name", structure.usages.name, settings);
+
+    H5::Group index = group.createGroup("step_index");
+    WriteInt32Column(index, "entity", structure.index.entity, settings);
+    WriteColumn(index, "offset", structure.index.offset, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64,
+                settings);
+    WriteColumn(index, "length", structure.index.length, H5::PredType::STD_U32LE, H5::PredType::NATIVE_UINT32,
+                settings);
+
+    H5::Attribute count = group.createAttribute("step_entities", H5::PredType::STD_I32LE, H5::DataSpace());
+    count.write(H5::PredType::NATIVE_INT32, &structure.nbEntities);
+}
@@ -0,0 +1,41 @@
+#ifndef STEPPRODUCTSTRUCTURE_E422101B_8E96_4308_80A6_44B93FC4977F
+#define STEPPRODUCTSTRUCTURE_E422101B_8E96_4308_80A6_44B93FC4977F
+
+#include <H5Cpp.h>
+
+#include "StringHeap.h"
+#include "H5AppendWriter.h"
+#include "StepScanner.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Product structure read straight from the STEP records, without OCCT's
+// parser or any shape transfer. One product row per PRODUCT_DEFINITION and one usage row
+// per NEXT_ASSEMBLY_USAGE_OCCURRENCE.
+struct ProductStructure {
+    struct Products {
+        std::vector<int32_t> entity; // STEP entity number (#n) of the PRODUCT_DEFINITION
+        std::vector<int32_t> id;     // string id of PRODUCT.id
+        std::vector<int32_t> name;   // string id of PRODUCT.name, falling back to id
+    } products;
+
+    struct Usages {
+        std::vector<int32_t> entity; // STEP entity number of the NAUO
+        std::vector<int32_t> parent; // product row of the relating definition, -1 if unknown
+        std::vector<int32_t> child;  // product row of the related definition, -1 if unknown
+        std::vector<int32_t> name;   // string id of the instance name
+    } usages;
+
+    int32_t nbEntities = 0;
+    StepEntityIndex index; // byte offset of every record, for later lazy decoding
+};
+
+// Parse stepFile and collect its product structure. Returns false when the file cannot be read.
+bool ReadProductStructure(const std::string& stepFile, StringHeap& strings, ProductStructure& structure);
+
+// Write /products, /assembly_usage and the /step_index tables under group.
+void WriteProductStructure(H5::Group& group, const ProductStructure& structure, const H5WriterSettings& settings);
+
+#endif /* STEPPRODUCTSTRUCTURE_E422101B_8E96_4308_80A6_44B93FC4977F */
@@ -0,0 +1,334 @@
+#include "StepScanner.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// First quote, semicolon or slash in [p, end): the only bytes that change the
+// statement state. Everything else is skipped a vector at a time.
+const char* FindStructural(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('\'');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i slash = _mm_set1_epi8('/');
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, semicolon)),
+                                          _mm_cmpeq_epi8(chunk, slash));
+        const int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\'' || *p == ';' || *p == '/') return p;
+    }
+    return end;
+}
+
+// p follows an opening quote; returns the byte after the closing one. A
+// doubled quote is an escaped quote inside the string.
+const char* SkipString(const char* p, const char* end) {
+    while (p < end) {
+        const char* q = static_cast<const char*>(std::memchr(p, '\'', static_cast<size_t>(end - p)));
+        if (!q) return end;
+        if (q + 1 < end && q[1] == '\'') {
+            p = q + 2;
+            continue;
+        }
+        return q + 1;
+    }
+    return end;
+}
+
+// p follows "/*"; returns the byte after the closing "*/".
+const char* SkipComment(const char* p, const char* end) {
+    const size_t close = std::string_view(p, static_cast<size_t>(end - p)).find("*/");
+    return close == std::string_view::npos ? end : p + close + 2;
+}
+
+const char* SkipSpace(const char* p, const char* end) {
+    while (p < end) {
+        if (IsSpace(*p)) {
+            ++p;
+        } else if (*p == '/' && p + 1 < end && p[1] == '*') {
+            p = SkipComment(p + 2, end);
+        } else {
+            break;
+        }
+    }
+    return p;
+}
+
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && IsSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && IsSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+// Position of the quote closing the string opened at text[open], npos if unterminated
+size_t ClosingQuote(std::string_view text, size_t open) {
+    for (size_t i = text.find('\'', open + 1); i != std::string_view::npos; i = text.find('\'', i + 2)) {
+        if (i + 1 >= text.size() || text[i + 1] != '\'') return i;
+    }
+    return std::string_view::npos;
+}
+
+bool ParseHex(std::string_view digits, uint32_t& value) {
+    const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value, 16);
+    return ec == std::errc() && end == digits.data() + digits.size();
+}
+
+void AppendUtf8(std::string& text, uint32_t code) {
+    if (code < 0x80) {
+        text += static_cast<char>(code);
+    } else if (code < 0x800) {
+        text += static_cast<char>(0xC0 | (code >> 6));
+        text += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        text += static_cast<char>(0xE0 | (code >> 12));
+        text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        text += static_cast<char>(0xF0 | (code >> 18));
+        text += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// \X2\ and \X4\ runs: fixed-width hex code units up to \X0\. Returns the
+// number of bytes consumed after the opening directive.
+size_t DecodeHexRun(std::string_view run, size_t width, std::string& text) {
+    size_t i = 0;
+    uint32_t highSurrogate = 0;
+    while (i + width <= run.size() && run[i] != '\\') {
+        uint32_t unit = 0;
+        if (!ParseHex(run.substr(i, width), unit)) break;
+        i += width;
+        if (width == 4 && unit >= 0xD800 && unit < 0xDC00) {
+            highSurrogate = unit;
+            continue;
+        }
+        if (width == 4 && highSurrogate != 0 && unit >= 0xDC00 && unit < 0xE000) {
+            unit = 0x10000 + ((highSurrogate - 0xD800) << 10) + (unit - 0xDC00);
+        }
+        highSurrogate = 0;
+        AppendUtf8(text, unit);
+    }
+    if (run.substr(i, 4) == "\\X0\\") i += 4;
+    return i;
+}
+
+} // namespace
+
+StepScanner::~StepScanner() {
+    Unmap();
+}
+
+void StepScanner::Unmap() {
+    if (myData) {
+        ::munmap(const_cast<char*>(myData), mySize);
+    }
+    myData = nullptr;
+    mySize = 0;
+    myHeader = std::string_view();
+    myIndex = StepEntityIndex();
+}
+
+bool StepScanner::Open(const std::string& stepFile, bool headerOnly) {
+    Unmap();
+
+    const int fd = ::open(stepFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    myData = static_cast<const char*>(data);
+    mySize = static_cast<size_t>(info.st_size);
+    if (!headerOnly) {
+        ::madvise(data, mySize, MADV_SEQUENTIAL);
+    }
+
+    const char* const begin = myData;
+    const char* const end = myData + mySize;
+    const char* statement = begin;
+    const char* headerBegin = nullptr;
+    bool first = true;
+    bool sorted = true;
+    for (const char* p = FindStructural(begin, end); p < end; p = FindStructural(p, end)) {
+        if (*p == '\'') {
+            p = SkipString(p + 1, end);
+            continue;
+        }
+        if (*p == '/') {
+            p = (p + 1 < end && p[1] == '*') ? SkipComment(p + 2, end) : p + 1;
+            continue;
+        }
+
+        const char* start = SkipSpace(statement, p);
+        statement = p + 1;
+        const std::string_view keyword = Trim(std::string_view(start, static_cast<size_t>(p - start)));
+        if (first) {
+            if (keyword != "ISO-10303-21") break;
+            first = false;
+        } else if (*start == '#') {
+            int32_t entity = 0;
+            const auto [digitsEnd, ec] = std::from_chars(start + 1, p, entity);
+            if (ec != std::errc() || digitsEnd == start + 1) continue;
+            const char* equals = SkipSpace(digitsEnd, p);
+            if (equals == p || *equals != '=') continue;
+
+            sorted = sorted && (myIndex.entity.empty() || myIndex.entity.back() < entity);
+            myIndex.entity.push_back(entity);
+            myIndex.offset.push_back(static_cast<uint64_t>(start - begin));
+            myIndex.length.push_back(static_cast<uint32_t>(p + 1 - start));
+        } else if (keyword == "HEADER") {
+            headerBegin = p + 1;
+        } else if (keyword == "ENDSEC" && headerBegin) {
+            // Only the first ENDSEC closes the header, even when it is empty
+            myHeader = Trim(std::string_view(headerBegin, static_cast<size_t>(start - headerBegin)));
+            headerBegin = nullptr;
+            if (headerOnly) break;
+        }
+        ++p;
+    }
+    if (first) {
+        Unmap();
+        return false;
+    }
+
+    if (!sorted) {
+        // Writers may emit records in any order; lookups need them by id
+        std::vector<size_t> order(myIndex.Size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) { return myIndex.entity[a] < myIndex.entity[b]; });
+        StepEntityIndex index;
+        for (const size_t i : order) {
+            index.entity.push_back(myIndex.entity[i]);
+            index.offset.push_back(myIndex.offset[i]);
+            index.length.push_back(myIndex.length[i]);
+        }
+        myIndex = std::move(index);
+    }
+
+    // From here on records are read by offset
+    ::madvise(data, mySize, MADV_RANDOM);
+    return true;
+}
+
+int32_t StepScanner::Find(int32_t entity) const {
+    auto found = std::lower_bound(myIndex.entity.begin(), myIndex.entity.end(), entity);
+    if (found == myIndex.entity.end() || *found != entity) return -1;
+    return static_cast<int32_t>(found - myIndex.entity.begin());
+}
+
+std::string_view StepScanner::Record(size_t i) const {
+    const std::string_view record(myData + myIndex.offset[i], myIndex.length[i] - 1);
+    return Trim(record.substr(record.find('=') + 1));
+}
+
+std::string_view StepTypeName(std::string_view record) {
+    record = Trim(record);
+    size_t end = 0;
+    while (end < record.size() && record[end] != '(' && !IsSpace(record[end])) ++end;
+    return record.substr(0, end);
+}
+
+bool SplitStepParameters(std::string_view record, std::vector<std::string_view>& parameters) {
+    parameters.clear();
+    const size_t open = record.find('(');
+    if (open == std::string_view::npos) return false;
+
+    int depth = 0;
+    size_t start = open + 1;
+    for (size_t i = open + 1; i < record.size(); ++i) {
+        const char c = record[i];
+        if (c == '\'') {
+            i = ClosingQuote(record, i);
+            if (i == std::string_view::npos) return false;
+        } else if (c == '"') {
+            i = record.find('"', i + 1);
+            if (i == std::string_view::npos) return false;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && depth > 0) {
+            --depth;
+        } else if (c == ')' || (c == ',' && depth == 0)) {
+            const std::string_view parameter = Trim(record.substr(start, i - start));
+            if (c == ',' || !parameter.empty() || !parameters.empty()) parameters.push_back(parameter);
+            if (c == ')') return true;
+            start = i + 1;
+        }
+    }
+    return false;
+}
+
+int32_t StepReference(std::string_view parameter) {
+    if (parameter.size() < 2 || parameter.front() != '#') return -1;
+    int32_t entity = -1;
+    const auto [end, ec] = std::from_chars(parameter.data() + 1, parameter.data() + parameter.size(), entity);
+    return ec == std::errc() && end == parameter.data() + parameter.size() ? entity : -1;
+}
+
+bool DecodeStepString(std::string_view parameter, std::string& text) {
+    text.clear();
+    if (parameter.size() < 2 || parameter.front() != '\'' || parameter.back() != '\'') return false;
+
+    const std::string_view body = parameter.substr(1, parameter.size() - 2);
+    for (size_t i = 0; i < body.size();) {
+        const char c = body[i];
+        if (c == '\'') {
+            text += '\''; // first of a doubled quote
+            i += 2;
+            continue;
+        }
+        const std::string_view rest = body.substr(i);
+        uint32_t code = 0;
+        if (c != '\\') {
+            text += c;
+            ++i;
+        } else if (rest.starts_with("\\\\")) {
+            text += '\\';
+            i += 2;
+        } else if (rest.starts_with("\\S\\") && rest.size() > 3) {
+            // Upper half of the selected ISO 8859 page; only Latin-1 is mapped
+            AppendUtf8(text, static_cast<unsigned char>(rest[3]) + 128u);
+            i += 4;
+        } else if (rest.size() >= 4 && rest.starts_with("\\P") && rest[3] == '\\') {
+            i += 4;
+        } else if (rest.starts_with("\\X\\") && rest.size() >= 5 && ParseHex(rest.substr(3, 2), code)) {
+            AppendUtf8(text, code);
+            i += 5;
+        } else if (rest.starts_with("\\X2\\")) {
+            i += 4 + DecodeHexRun(rest.substr(4), 4, text);
+        } else if (rest.starts_with("\\X4\\")) {
+            i += 4 + DecodeHexRun(rest.substr(4), 8, text);
+        } else {
+            text += c;
+            ++i;
+        }
+    }
+    return true;
+}
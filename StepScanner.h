@@ -0,0 +1,72 @@
+#ifndef STEPSCANNER_9B3E7D21_6A4C_4F58_B1D2_84E0C5A7F613
+#define STEPSCANNER_9B3E7D21_6A4C_4F58_B1D2_84E0C5A7F613
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Where every "#id=...;" record of a STEP file starts, ordered by id.
+struct StepEntityIndex {
+    std::vector<int32_t> entity;  // STEP entity number (#n)
+    std::vector<uint64_t> offset; // byte offset of the record's '#'
+    std::vector<uint32_t> length; // bytes up to and including the closing ';'
+
+    size_t Size() const { return entity.size(); }
+};
+
+// ISO 10303-21 file mapped read-only, indexed in one pass without building
+// any entity objects. Statement boundaries are found 16 bytes at a time with
+// SSE2, skipping quoted strings and comments; records are decoded only when
+// a caller asks for them.
+class StepScanner {
+public:
+    StepScanner() = default;
+    ~StepScanner();
+    StepScanner(const StepScanner&) = delete;
+    StepScanner& operator=(const StepScanner&) = delete;
+
+    // Map stepFile and index its records. Returns false when the file cannot
+    // be mapped or is not a Part 21 exchange structure. With headerOnly the
+    // scan stops at the end of the HEADER section, so only Header() is set
+    // and only the first pages of the file are read.
+    bool Open(const std::string& stepFile, bool headerOnly = false);
+
+    const StepEntityIndex& Index() const { return myIndex; }
+    size_t Size() const { return myIndex.Size(); }
+
+    // Position of entity in Index(), -1 when the file has no such record.
+    int32_t Find(int32_t entity) const;
+
+    // Text between '=' and ';' of the record at position i, e.g.
+    // "PRODUCT('A','A','',(#31))".
+    std::string_view Record(size_t i) const;
+
+    // Statements between HEADER; and ENDSEC;, empty when absent.
+    std::string_view Header() const { return myHeader; }
+
+private:
+    void Unmap();
+
+    const char* myData = nullptr;
+    size_t mySize = 0;
+    std::string_view myHeader;
+    StepEntityIndex myIndex;
+};
+
+// Entity type of a simple record, empty for complex "(A()B())" records.
+std::string_view StepTypeName(std::string_view record);
+
+// Top-level parameters of a simple record, each trimmed of white space.
+// Returns false when the parentheses or quotes do not balance.
+bool SplitStepParameters(std::string_view record, std::vector<std::string_view>& parameters);
+
+// Entity number of a "#n" parameter, -1 for anything else.
+int32_t StepReference(std::string_view parameter);
+
+// Quoted parameter as UTF-8. Resolves doubled quotes and the control
+// directives \S\, \X\, \X2\ and \X4\ of ISO 10303-21. Returns false for $
+// and non-string parameters.
+bool DecodeStepString(std::string_view parameter, std::string& text);
+
+#endif /* STEPSCANNER_9B3E7D21_6A4C_4F58_B1D2_84E0C5A7F613 */
@@ -0,0 +1,606 @@
+#include "StepToH5Converter.h"
+
+#include <STEPCAFControl_Controller.hxx>
+#include <STEPCAFControl_Reader.hxx>
+#include <BinXCAFDrivers.hxx>
+#include <Standard_Version.hxx>
+#include <TDocStd_Document.hxx>
+#include <XCAFApp_Application.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+
+#include <H5Cpp.h>
+
+#include "StepLabelTable.h"
+#include "MassProperties.h"
+#include "StepProductStructure.h"
+#include "StepProbe.h"
+#include "ConversionProfile.h"
+#include "ConversionProgress.h"
+#include "IncrementalExport.h"
+#include "ConversionCache.h"
+#include "LabelGroupWriter.h"
+#include "InstanceTable.h"
+#include "OccurrenceTable.h"
+#include "MeshExport.h"
+#include "SpatialIndex.h"
+#include "ShardedExport.h"
+#include "ColorTable.h"
+#include "MembershipTable.h"
+#include "NameIndex.h"
+
+#include <filesystem>
+#include <iostream>
+#include <optional>
+
+namespace {
+
+// Bump when the output of a given input and option set changes, so that
+// existing cache entries stop matching
+constexpr uint64_t theCacheFormat = 9;
+
+// Same for stored XDE documents, e.g. when the reader modes change
+constexpr uint64_t theDocumentFormat = 1;
+
+// TDocStd_Application keeps its open documents in a shared directory
+std::mutex theAppMutex;
+
+// Opens a fresh XDE document and closes it again when leaving scope.
+class XdeDocument {
+public:
+    XdeDocument() : myApp(XCAFApp_Application::GetApplication()) {
+        std::lock_guard<std::mutex> lock(theAppMutex);
+        myApp->NewDocument("MDTV-XCAF", myDoc);
+    }
+    ~XdeDocument() {
+        std::lock_guard<std::mutex> lock(theAppMutex);
+        myApp->Close(myDoc);
+    }
+    XdeDocument(const XdeDocument&) = delete;
+    XdeDocument& operator=(const XdeDocument&) = delete;
+
+    const Handle(TDocStd_Document)& Get() const { return myDoc; }
+
+    // Replace the document with the one stored at path.
+    bool Open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(theAppMutex);
+        Handle(TDocStd_Document) stored;
+        if (myApp->Open(TCollection_ExtendedString(path.c_str(), true), stored) != PCDM_RS_OK) return false;
+        myApp->Close(myDoc);
+        myDoc = stored;
+        return true;
+    }
+
+    // Store the document at path in the BinXCAF format.
+    bool SaveAs(const std::string& path) {
+        std::lock_guard<std::mutex> lock(theAppMutex);
+        myDoc->ChangeStorageFormat("BinXCAF");
+        return myApp->SaveAs(myDoc, TCollection_ExtendedString(path.c_str(), true)) == PCDM_SS_OK;
+    }
+
+private:
+    Handle(XCAFApp_Application) myApp;
+    Handle(TDocStd_Document) myDoc;
+};
+
+void UnlinkIfExists(H5::H5File& file, const char* name) {
+    if (file.nameExists(name)) {
+        file.unlink(name);
+    }
+}
+
+// Replace group `name` of file with a new, empty one.
+H5::Group RecreateGroup(H5::H5File& file, const char* name) {
+    UnlinkIfExists(file, name);
+    return file.createGroup(name);
+}
+
+// Only the flat layout of a full conversion is split into shards
+bool IsShardedExport(const ConvertOptions& options) {
+    return !options.probe && !options.attributesOnly && options.layout == LabelLayout::Flat && options.shards > 1;
+}
+
+// Size of the file at path, 0 when it cannot be read.
+uintmax_t FileBytes(const std::string& path) {
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : size;
+}
+
+// Attribute-only path: names and structure from the entity graph, no Transfer.
+bool ConvertProductStructure(const std::string& stepFile, const std::string& hdf5File,
+                             const ConvertOptions& options, ConversionProfile* profile, ConversionProgress& progress) {
+    StringHeap strings;
+    ProductStructure structure;
+    ConversionProfile::Phase readPhase(profile, "read");
+    progress.Begin("read", "bytes");
+    if (!ReadProductStructure(stepFile, strings, structure)) {
+        std::cerr << "Failed to read STEP file: " << stepFile << "\n";
+        return false;
+    }
+    readPhase.Stop();
+    progress.End(static_cast<double>(FileBytes(stepFile)));
+    if (progress.Stopped()) return false;
+    if (profile) {
+        profile->SetCounter("entities", structure.nbEntities);
+        profile->SetCounter("products", static_cast<int64_t>(structure.products.entity.size()));
+        profile->SetCounter("assembly_usages", static_cast<int64_t>(structure.usages.entity.size()));
+    }
+
+    std::lock_guard<std::mutex> lock(Hdf5Mutex());
+    try {
+        ConversionProfile::Phase writePhase(profile, "write");
+        H5::H5File file(hdf5File, H5F_ACC_TRUNC);
+        H5::Group rootGroup = file.openGroup("/");
+        WriteProductStructure(rootGroup, structure, options.storage);
+        H5::Group stringGroup = file.createGroup("/strings");
+        strings.Write(stringGroup, options.storage);
+        writePhase.Stop();
+
+        ConversionProfile::Phase closePhase(profile, "close");
+        stringGroup.close();
+        rootGroup.close();
+        file.close();
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Probe path: the Part 21 header, and with probeScan the entity index, as one Meta row.
+bool ConvertProbe(const std::string& stepFile, const std::string& hdf5File, const ConvertOptions& options,
+                  ConversionProfile* profile) {
+    StepProbe probe;
+    ConversionProfile::Phase readPhase(profile, "read");
+    if (!ProbeStepFile(stepFile, options.probeScan, probe)) {
+        std::cerr << "Failed to read STEP file: " << stepFile << "\n";
+        return false;
+    }
+    readPhase.Stop();
+    if (profile && probe.nbEntities >= 0) {
+        profile->SetCounter("entities", probe.nbEntities);
+    }
+
+    std::lock_guard<std::mutex> lock(Hdf5Mutex());
+    try {
+        ConversionProfile::Phase writePhase(profile, "write");
+        H5::H5File file(hdf5File, H5F_ACC_TRUNC);
+        H5::Group rootGroup = file.openGroup("/");
+        WriteStepProbe(rootGroup, probe, stepFile);
+        writePhase.Stop();
+
+        ConversionProfile::Phase closePhase(profile, "close");
+        rootGroup.close();
+        file.close();
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// ReadFile and Transfer of stepFile into doc.
+bool TransferStepFile(const std::string& stepFile, XdeDocument& doc, ConversionProfile* profile,
+                      ConversionProgress& progress) {
+    STEPCAFControl_Reader reader;
+    reader.SetColorMode(true);
+    reader.SetNameMode(true);
+    reader.SetLayerMode(true);
+
+    // ReadFile takes no progress range; its rate is reported once it returns
+    ConversionProfile::Phase readPhase(profile, "read");
+    progress.Begin("read", "bytes");
+    IFSelect_ReturnStatus status = reader.ReadFile(stepFile.c_str());
+    if (status != IFSelect_RetDone) {
+        std::cerr << "Failed to read STEP file: " << stepFile << "\n";
+        return false;
+    }
+    readPhase.Stop();
+    progress.End(static_cast<double>(FileBytes(stepFile)));
+    const int nbEntities = reader.ChangeReader().Model().IsNull() ? 0 : reader.ChangeReader().Model()->NbEntities();
+    if (profile) {
+        profile->SetCounter("entities", nbEntities);
+    }
+    if (progress.Stopped()) return false;
+
+    ConversionProfile::Phase transferPhase(profile, "transfer");
+    const bool transferred = reader.Transfer(doc.Get(), progress.Begin("transfer", "entities", nbEntities));
+    if (progress.Stopped()) return false;
+    if (!transferred) {
+        std::cerr << "Failed to transfer STEP to XDE document: " << stepFile << "\n";
+        return false;
+    }
+    progress.End(nbEntities);
+    return true;
+}
+
+// Full path: STEP -> XDE document -> label tables.
+bool ConvertXdeDocument(const std::string& stepFile, const std::string& hdf5File,
+                        const ConvertOptions& options, ConversionProfile* profile, ConversionProgress& progress) {
+    // Each conversion owns its document, so workers never share OCAF data
+    XdeDocument doc;
+
+    // A document stored by an earlier run of the same input replaces ReadFile and Transfer
+    std::optional<ConversionCache> documentCache;
+    uint64_t documentKey = 0;
+    const std::string documentFile = hdf5File + ".xbf";
+    bool loaded = false;
+    if (!options.documentCacheDir.empty()) {
+        ConversionProfile::Phase lookupPhase(profile, "document_lookup");
+        ContentHash hash(theDocumentFormat);
+        if (HashFileContents(stepFile, hash)) {
+            hash.AddValue(static_cast<int32_t>(OCC_VERSION_HEX));
+            documentCache.emplace(options.documentCacheDir, options.cacheMaxBytes, ".xbf");
+            documentKey = hash.Value();
+            loaded = documentCache->Fetch(documentKey, documentFile) && doc.Open(documentFile);
+            std::error_code ec;
+            std::filesystem::remove(documentFile, ec);
+            if (profile) {
+                profile->SetCounter("document_hits", loaded ? 1 : 0);
+                profile->SetCounter("document_misses", loaded ? 0 : 1);
+            }
+        }
+    }
+    if (!loaded) {
+        if (!TransferStepFile(stepFile, doc, profile, progress)) return false;
+        if (documentCache) {
+            ConversionProfile::Phase storePhase(profile, "document_store");
+            if (!doc.SaveAs(documentFile) || !documentCache->Store(documentKey, documentFile)) {
+                std::cerr << "Failed to cache document: " << stepFile << "\n";
+            }
+            std::error_code ec;
+            std::filesystem::remove(documentFile, ec);
+        }
+    }
+
+    // Get the root label
+    TDF_Label shapeLabel = XCAFDoc_DocumentTool::ShapesLabel(doc.Get()->Main());
+
+    // Collect the flat tables before taking the HDF5 lock
+    StringHeap strings;
+    LabelTable labels;
+    InstanceTable instances;
+    OccurrenceTable occurrences;
+    MeshTable meshes;
+    BoundsTable bounds;
+    BvhTable bvh;
+    ColorTable colors;
+    MembershipTable layers;
+    MembershipTable materials;
+    NameIndex names;
+    MassPropertyTable properties;
+    PreviousExport previous;
+    bool update = false;
+    // Virtual datasets cannot grow, so a sharded export is always rewritten
+    const bool sharded = IsShardedExport(options);
+    if (options.layout == LabelLayout::Flat && options.incremental && !sharded) {
+        std::lock_guard<std::mutex> lock(Hdf5Mutex());
+        update = ReadPreviousExport(hdf5File, strings, previous);
+        if (update && (previous.hasProperties != options.massProperties || options.mesh || options.bvh)) {
+            // Different table set, or a mesh or BVH that is always rebuilt: fall back to a full export
+            update = false;
+            strings = StringHeap();
+        }
+    }
+    if (options.layout == LabelLayout::Flat) {
+        ConversionProfile::Phase labelPhase(profile, "labels");
+        labels = BuildLabelTable(shapeLabel, strings, progress.Begin("labels", "labels"));
+        labelPhase.Stop();
+        if (progress.Stopped()) return false;
+        progress.End(static_cast<double>(labels.Size()));
+        if (profile) {
+            profile->SetCounter("labels", static_cast<int64_t>(labels.Size()));
+            profile->SetCounter("strings", static_cast<int64_t>(strings.Size()));
+        }
+
+        instances = BuildInstanceTable(labels);
+        layers = BuildLayerTable(labels, strings);
+        materials = BuildMaterialTable(labels, strings);
+        names = BuildNameIndex(labels, strings);
+        if (profile) {
+            profile->SetCounter("instances", static_cast<int64_t>(instances.Size()));
+            profile->SetCounter("layers", static_cast<int64_t>(layers.Size()));
+            profile->SetCounter("materials", static_cast<int64_t>(materials.Size()));
+        }
+        if (options.colors) {
+            ConversionProfile::Phase colorPhase(profile, "colors");
+            colors = BuildColorTable(labels);
+            colorPhase.Stop();
+            if (profile) {
+                profile->SetCounter("palette_colors", static_cast<int64_t>(colors.PaletteSize()));
+            }
+        }
+        if (options.worldTransforms) {
+            ConversionProfile::Phase occurrencePhase(profile, "occurrences");
+            occurrences = BuildOccurrenceTable(labels, instances);
+            occurrencePhase.Stop();
+            if (profile) {
+                profile->SetCounter("occurrences", static_cast<int64_t>(occurrences.Size()));
+            }
+        }
+
+        if (options.massProperties) {
+            ConversionProfile::Phase propertyPhase(profile, "properties");
+            properties = ComputeMassProperties(labels, progress.Begin("properties", "shapes"));
+            propertyPhase.Stop();
+            if (progress.Stopped()) return false;
+            progress.End(static_cast<double>(properties.Size()));
+            if (profile) {
+                profile->SetCounter("property_shapes", static_cast<int64_t>(properties.Size()));
+            }
+        }
+        if (options.mesh) {
+            ConversionProfile::Phase meshPhase(profile, "mesh");
+            meshes = ComputeMeshes(labels, options.meshDeflection, options.meshAngle,
+                                   progress.Begin("mesh", "shapes"));
+            meshPhase.Stop();
+            if (progress.Stopped()) return false;
+            progress.End(static_cast<double>(meshes.Size()));
+            if (profile) {
+                profile->SetCounter("mesh_vertices", static_cast<int64_t>(meshes.vertexOffset.back()));
+                profile->SetCounter("mesh_triangles", static_cast<int64_t>(meshes.triangleOffset.back()));
+            }
+        }
+        if (options.bvh) {
+            ConversionProfile::Phase boundsPhase(profile, "bounds");
+            bounds = ComputeBounds(labels, occurrences);
+            bvh = BuildBvh(bounds);
+            boundsPhase.Stop();
+            if (progress.Stopped()) return false;
+            if (profile) {
+                profile->SetCounter("bounded_shapes", static_cast<int64_t>(bounds.shapeLabel.size()));
+                profile->SetCounter("bvh_nodes", static_cast<int64_t>(bvh.Size()));
+            }
+        }
+        ComputeSubtreeHashes(labels, strings, options.massProperties ? &properties : nullptr);
+    }
+
+    // A write that has started runs to the end, so that no half-written file is left
+    if (progress.Stopped()) return false;
+
+    if (options.layout == LabelLayout::Groups) {
+        // The walk feeds a writer thread that takes the HDF5 lock per batch
+        ConversionProfile::Phase writePhase(profile, "write");
+        const int64_t groups = WriteLabelGroups(shapeLabel, hdf5File);
+        if (groups < 0) return false;
+        if (profile) {
+            profile->SetCounter("labels", groups);
+        }
+        return true;
+    }
+
+    // The shard writers are processes of their own, so the HDF5 lock is only
+    // taken for the master file and other conversions keep writing meanwhile
+    const MassPropertyTable* shardProperties = options.massProperties ? &properties : nullptr;
+    const MeshTable* shardMeshes = options.mesh ? &meshes : nullptr;
+    ShardPlan plan;
+    if (sharded) {
+        ConversionProfile::Phase shardPhase(profile, "write_shards");
+        plan = PlanShards(labels, shardProperties, shardMeshes, options.shards);
+        if (profile) {
+            profile->SetCounter("shards", static_cast<int64_t>(plan.Size()));
+        }
+        if (!WriteShards(hdf5File, plan, labels, shardProperties, shardMeshes, options.storage)) {
+            std::cerr << "Failed to write the shards of: " << hdf5File << "\n";
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(Hdf5Mutex());
+    progress.Begin("write", "bytes");
+    try {
+        ConversionProfile::Phase writePhase(profile, "write");
+        if (update) {
+            H5::H5File file(hdf5File, H5F_ACC_RDWR);
+            const size_t rows = UpdateExport(file, previous, labels, strings,
+                                             options.massProperties ? &properties : nullptr);
+            if (profile) {
+                profile->SetCounter("rows_rewritten", static_cast<int64_t>(rows));
+            }
+            // Derived tables are replaced as a whole
+            H5::Group instanceGroup = RecreateGroup(file, "/instances");
+            WriteInstanceTable(instanceGroup, instances, options.storage);
+            H5::Group layerGroup = RecreateGroup(file, "/layers");
+            WriteMembershipTable(layerGroup, layers, options.storage);
+            H5::Group materialGroup = RecreateGroup(file, "/materials");
+            WriteMembershipTable(materialGroup, materials, options.storage);
+            H5::Group nameGroup = RecreateGroup(file, "/name_index");
+            WriteNameIndex(nameGroup, names, options.storage);
+            if (options.worldTransforms) {
+                H5::Group occurrenceGroup = RecreateGroup(file, "/occurrences");
+                WriteOccurrenceTable(occurrenceGroup, occurrences, options.storage);
+            } else {
+                UnlinkIfExists(file, "/occurrences");
+            }
+            UnlinkIfExists(file, "/mesh");
+            UnlinkIfExists(file, "/bounds");
+            UnlinkIfExists(file, "/bvh");
+            UnlinkIfExists(file, "/ColorPalette");
+            UnlinkIfExists(file, "/ColorSurface");
+            UnlinkIfExists(file, "/ColorVertex");
+            if (options.colors) {
+                H5::Group rootGroup = file.openGroup("/");
+                WriteColorTable(rootGroup, colors, options.storage);
+            }
+            writePhase.Stop();
+
+            ConversionProfile::Phase closePhase(profile, "close");
+            file.close();
+            progress.End(static_cast<double>(FileBytes(hdf5File)));
+            return true;
+        }
+
+        H5::H5File file(hdf5File, H5F_ACC_TRUNC);
+        if (sharded) {
+            WriteShardViews(file, hdf5File, plan, labels, shardProperties, shardMeshes, options.storage);
+        } else {
+            H5::Group labelGroup = file.createGroup("/labels");
+            WriteLabelTable(labelGroup, labels, options.storage);
+        }
+        H5::Group stringGroup = file.createGroup("/strings");
+        strings.Write(stringGroup, options.storage);
+        H5::Group instanceGroup = file.createGroup("/instances");
+        WriteInstanceTable(instanceGroup, instances, options.storage);
+        H5::Group layerGroup = file.createGroup("/layers");
+        WriteMembershipTable(layerGroup, layers, options.storage);
+        H5::Group materialGroup = file.createGroup("/materials");
+        WriteMembershipTable(materialGroup, materials, options.storage);
+        H5::Group nameGroup = file.createGroup("/name_index");
+        WriteNameIndex(nameGroup, names, options.storage);
+        if (options.worldTransforms) {
+            H5::Group occurrenceGroup = file.createGroup("/occurrences");
+            WriteOccurrenceTable(occurrenceGroup, occurrences, options.storage);
+        }
+        if (options.mesh && !sharded) {
+            H5::Group meshGroup = file.createGroup("/mesh");
+            WriteMeshTable(meshGroup, meshes, options.storage);
+        }
+        if (options.bvh) {
+            H5::Group boundsGroup = file.createGroup("/bounds");
+            WriteBounds(boundsGroup, bounds, options.storage);
+            H5::Group bvhGroup = file.createGroup("/bvh");
+            WriteBvh(bvhGroup, bvh, options.storage);
+        }
+        H5::Group rootGroup = file.openGroup("/");
+        if (options.massProperties && !sharded) {
+            WriteMassProperties(rootGroup, properties, options.storage);
+        }
+        if (options.colors) {
+            WriteColorTable(rootGroup, colors, options.storage);
+        }
+        writePhase.Stop();
+
+        ConversionProfile::Phase closePhase(profile, "close");
+        file.close();
+    } catch (H5::FileIException& e) {
+        std::cerr << "HDF5 File Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+        return false;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+        return false;
+    }
+
+    progress.End(static_cast<double>(FileBytes(hdf5File)));
+    return true;
+}
+
+// Hash of everything that determines the output file: the input bytes and
+// the options that change what is written.
+bool HashConversionInput(const std::string& stepFile, const ConvertOptions& options, ContentHash& hash) {
+    if (!HashFileContents(stepFile, hash)) return false;
+    hash.AddValue(static_cast<int32_t>(options.layout));
+    hash.AddValue(options.massProperties);
+    hash.AddValue(options.attributesOnly);
+    hash.AddValue(options.colors);
+    hash.AddValue(options.worldTransforms);
+    hash.AddValue(options.mesh);
+    hash.AddValue(options.meshDeflection);
+    hash.AddValue(options.meshAngle);
+    hash.AddValue(options.bvh);
+    hash.AddValue(options.storage.chunkRows);
+    hash.AddValue(options.storage.deflateLevel);
+    return true;
+}
+
+// Store the report in the finished file and next to it as JSON.
+bool WriteProfile(const std::string& stepFile, const std::string& hdf5File, ConversionProfile& profile) {
+    UnshareFile(hdf5File, true);
+    {
+        std::lock_guard<std::mutex> lock(Hdf5Mutex());
+        try {
+            H5::H5File file(hdf5File, H5F_ACC_RDWR);
+            if (file.nameExists("/profile")) {
+                file.unlink("/profile"); // left by an earlier run of an incremental export
+            }
+            profile.SetCounter("hdf5_objects", ConversionProfile::CountHdf5Objects(file));
+            H5::Group group = file.createGroup("/profile");
+            profile.WriteAttributes(group);
+        } catch (H5::Exception& e) {
+            std::cerr << "HDF5 Error: " << hdf5File << ": " << e.getCDetailMsg() << "\n";
+            return false;
+        }
+    }
+
+    const std::string jsonFile = hdf5File + ".profile.json";
+    if (!profile.WriteJson(jsonFile, stepFile, hdf5File)) {
+        std::cerr << "Failed to write profile: " << jsonFile << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void InitializeConverter() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        STEPCAFControl_Controller::Init();
+        BinXCAFDrivers::DefineFormat(XCAFApp_Application::GetApplication());
+    });
+}
+
+std::mutex& Hdf5Mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+bool ConvertStepFile(const std::string& stepFile, const std::string& hdf5File, const ConvertOptions& options) {
+    InitializeConverter();
+
+    ConversionProfile profile;
+    ConversionProfile* activeProfile = options.profile ? &profile : nullptr;
+    Handle(ConversionProgress) progress = new ConversionProgress(stepFile, options.progressSeconds,
+                                                                 options.deadlineSeconds, options.cancel, activeProfile);
+
+    // Shards of an earlier sharded export would outlive this one
+    if (!IsShardedExport(options)) {
+        RemoveStaleShards(hdf5File, 0);
+    }
+
+    // Hashing the input for the cache would read more of it than a probe does
+    if (options.probe) {
+        UnshareFile(hdf5File, false);
+        if (!ConvertProbe(stepFile, hdf5File, options, activeProfile)) return false;
+        return activeProfile ? WriteProfile(stepFile, hdf5File, profile) : true;
+    }
+
+    std::optional<ConversionCache> cache;
+    uint64_t cacheKey = 0;
+    // A cache entry would only hold the master file, not its shards
+    if (!options.cacheDir.empty() && options.shards <= 1) {
+        ConversionProfile::Phase lookupPhase(activeProfile, "cache_lookup");
+        ContentHash hash(theCacheFormat);
+        if (HashConversionInput(stepFile, options, hash)) {
+            cache.emplace(options.cacheDir, options.cacheMaxBytes);
+            cacheKey = hash.Value();
+            const bool hit = cache->Fetch(cacheKey, hdf5File);
+            if (activeProfile) {
+                activeProfile->SetCounter("cache_hits", hit ? 1 : 0);
+                activeProfile->SetCounter("cache_misses", hit ? 0 : 1);
+            }
+            if (hit) {
+                lookupPhase.Stop();
+                return activeProfile ? WriteProfile(stepFile, hdf5File, profile) : true;
+            }
+        }
+    }
+
+    // An output hard-linked from the cache must not be rewritten in place
+    UnshareFile(hdf5File, options.incremental);
+
+    const bool converted = options.attributesOnly
+        ? ConvertProductStructure(stepFile, hdf5File, options, activeProfile, *progress)
+        : ConvertXdeDocument(stepFile, hdf5File, options, activeProfile, *progress);
+    if (!converted) return false;
+
+    // An updated file keeps the strings of rows it dropped, so it is not the
+    // output a full conversion of the same input would store
+    if (cache && !options.incremental) {
+        ConversionProfile::Phase storePhase(activeProfile, "cache_store");
+        if (!cache->Store(cacheKey, hdf5File)) {
+            std::cerr << "Failed to cache: " << hdf5File << "\n";
+        }
+    }
+
+    return activeProfile ? WriteProfile(stepFile, hdf5File, profile) : true;
+}
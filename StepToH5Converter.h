@@ -0,0 +1,52 @@
+#ifndef STEPTOH5CONVERTER_FE8B4C6F_3D1B_4536_8D37_A43B78321CEA
+#define STEPTOH5CONVERTER_FE8B4C6F_3D1B_4536_8D37_A43B78321CEA
+
+#include "H5AppendWriter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class LabelLayout {
+    Flat,   // one row per label in the /labels datasets
+    Groups  // legacy: one H5::Group per label under /properties
+};
+
+struct ConvertOptions {
+    LabelLayout layout = LabelLayout::Flat;
+    bool massProperties = true; // Properties table, flat layout only
+    bool colors = true;         // ColorPalette/ColorSurface/ColorVertex, flat layout only
+    bool attributesOnly = false; // product structure from the STEP model, no shape transfer
+    bool probe = false;          // only the header summary as a one-row Meta dataset
+    bool probeScan = false;      // probe: also count entities and find the length unit
+    H5WriterSettings storage;    // chunking and compression of every table
+    bool profile = false;        // phase timings to <output>.profile.json and /profile
+    bool incremental = false;    // rewrite only changed rows of an existing flat export; mesh or bvh force a full one
+    bool worldTransforms = false; // expanded /occurrences table with world transforms, flat layout only
+    bool mesh = false;            // /mesh triangulation of every prototype, flat layout only
+    double meshDeflection = 0.1;  // linear deflection in model units
+    double meshAngle = 0.5;       // angular deflection in radians
+    bool bvh = false;             // /bounds boxes and a /bvh over them, needs worldTransforms
+    int shards = 0;               // labels, properties and mesh in this many shard files, flat layout only
+    std::string cacheDir;        // reuse outputs of identical inputs from here when set
+    uint64_t cacheMaxBytes = 0;  // evict least recently used entries past this size, 0 = unlimited
+    std::string documentCacheDir; // transferred XDE documents in BinXCAF, reused instead of parsing the STEP file
+    double progressSeconds = 0.0; // print phase progress and rates on std::cerr this often, 0 = never
+    double deadlineSeconds = 0.0; // give up on a file after this long, 0 = no limit
+    const std::atomic<bool>* cancel = nullptr; // give up on the current file once set
+};
+
+// One-time OCCT setup (STEP schema protocol, XCAF application).
+// Call before converting from several threads at once.
+void InitializeConverter();
+
+// Guards every call into the HDF5 library, which is not thread-safe.
+std::mutex& Hdf5Mutex();
+
+// Read stepFile into its own XDE document and write the attributes to hdf5File.
+// Errors are reported on std::cerr; returns false when the file was not converted,
+// including when the deadline passed or cancel was set before the write began.
+bool ConvertStepFile(const std::string& stepFile, const std::string& hdf5File, const ConvertOptions& options);
+
+#endif /* STEPTOH5CONVERTER_FE8B4C6F_3D1B_4536_8D37_A43B78321CEA */
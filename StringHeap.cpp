@@ -0,0 +1,56 @@
+#include "StringHeap.h"
+
+#include "H5Columns.h"
+
+StringHeap::StringHeap() : myOffsets(1, 0) {}
+
+int32_t StringHeap::Add(std::string_view str) {
+    auto found = myIds.find(str);
+    if (found != myIds.end()) return found->second;
+
+    const int32_t id = static_cast<int32_t>(Size());
+    myBytes.append(str);
+    myOffsets.push_back(myBytes.size());
+    myIds.emplace(std::string(str), id);
+    return id;
+}
+
+int32_t StringHeap::AddExtended(const TCollection_ExtendedString& str) {
+    // Convert straight to UTF-8 into a reused buffer, no temporary AsciiString
+    myScratch.resize(static_cast<size_t>(str.LengthOfCString()) + 1);
+    Standard_PCharacter buffer = myScratch.data();
+    const Standard_Integer length = str.ToUTF8CString(buffer);
+    return Add(std::string_view(myScratch.data(), static_cast<size_t>(length)));
+}
+
+std::string_view StringHeap::Get(int32_t id) const {
+    const uint64_t begin = myOffsets[static_cast<size_t>(id)];
+    const uint64_t end = myOffsets[static_cast<size_t>(id) + 1];
+    return std::string_view(myBytes).substr(begin, end - begin);
+}
+
+void StringHeap::Write(H5::Group& group, const H5WriterSettings& settings) const {
+    H5AppendWriter<char> data(group, "data", H5::PredType::STD_U8LE, H5::PredType::NATIVE_UINT8, 1, settings);
+    data.Append(myBytes.data(), myBytes.size());
+    data.Close();
+
+    WriteColumn(group, "offsets", myOffsets, H5::PredType::STD_U64LE, H5::PredType::NATIVE_UINT64, settings);
+}
+
+void StringHeap::Read(const H5::Group& group) {
+    H5::DataSet data = group.openDataSet("data");
+    H5::DataSet offsets = group.openDataSet("offsets");
+
+    std::string bytes(static_cast<size_t>(data.getSpace().getSimpleExtentNpoints()), '\0');
+    if (!bytes.empty()) {
+        data.read(bytes.data(), H5::PredType::NATIVE_UINT8);
+    }
+    std::vector<uint64_t> bounds(static_cast<size_t>(offsets.getSpace().getSimpleExtentNpoints()));
+    if (!bounds.empty()) {
+        offsets.read(bounds.data(), H5::PredType::NATIVE_UINT64);
+    }
+
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        Add(std::string_view(bytes).substr(bounds[i], bounds[i + 1] - bounds[i]));
+    }
+}
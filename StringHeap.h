@@ -0,0 +1,50 @@
+#ifndef STRINGHEAP_46D8091B_8965_4F6D_B446_F7DBD7414A0D
+#define STRINGHEAP_46D8091B_8965_4F6D_B446_F7DBD7414A0D
+
+#include <TCollection_ExtendedString.hxx>
+
+#include <H5Cpp.h>
+
+#include "H5AppendWriter.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Deduplicated UTF-8 string storage shared by all tables of one output file.
+// String i occupies bytes [offsets[i], offsets[i + 1]) of the heap.
+class StringHeap {
+public:
+    StringHeap();
+
+    // Id of str, adding it on first use.
+    int32_t Add(std::string_view str);
+    int32_t AddExtended(const TCollection_ExtendedString& str);
+
+    std::string_view Get(int32_t id) const;
+    size_t Size() const { return myOffsets.size() - 1; }
+    const std::string& Bytes() const { return myBytes; }
+    const std::vector<uint64_t>& Offsets() const { return myOffsets; }
+
+    // Write "data" (uint8) and "offsets" (uint64, Size() + 1 entries) into group.
+    void Write(H5::Group& group, const H5WriterSettings& settings) const;
+
+    // Re-intern the strings of a group written by Write(), keeping their ids.
+    void Read(const H5::Group& group);
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+    };
+
+    std::string myBytes;
+    std::vector<uint64_t> myOffsets;
+    std::unordered_map<std::string, int32_t, Hash, std::equal_to<>> myIds;
+    std::string myScratch; // reused UTF-8 conversion buffer
+};
+
+#endif /* STRINGHEAP_46D8091B_8965_4F6D_B446_F7DBD7414A0D */
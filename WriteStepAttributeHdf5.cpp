@@ -1,98 +1,192 @@
-#include <STEPCAFControl_Reader.hxx>
-#include <TDocStd_Document.hxx>
-#include <XCAFApp_Application.hxx>
-#include <XCAFDoc_DocumentTool.hxx>
-#include <TDataStd_Name.hxx>
-#include <TDF_LabelSequence.hxx>
-#include <TDF_Tool.hxx>
-#include <TDF_ChildIterator.hxx>
-
-#include <H5Cpp.h>
-
+#include "StepToH5Converter.h"
+#include "BatchConverter.h"
+#include "ConversionDaemon.h"
+#include "ShardedExport.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
+
+static void PrintUsage() {
+    std::cerr << "Usage: step2hdf5 [options] input.step output.h5\n"
+                 "       step2hdf5 [options] --batch <dir|list.txt> [--output-dir dir] [--jobs n]\n"
+                 "       step2hdf5 [options] --serve-socket path [--output-dir dir] [--jobs n]\n"
+                 "       step2hdf5 [options] --serve-spool dir [--output-dir dir] [--jobs n]\n"
+                 "Options:\n"
+                 "  --layout flat|groups   label table layout (default: flat)\n"
+                 "  --no-properties        skip the volume/area/centroid Properties table\n"
+                 "  --no-colors            skip the ColorPalette/ColorSurface/ColorVertex datasets\n"
+                 "  --attributes-only      write product names and structure without shape transfer\n"
+                 "  --probe                write only a one-row Meta dataset with the file's header: schema,\n"
+                 "                         application protocol, originating system and time stamp\n"
+                 "  --probe-scan           with --probe, also count the entities and find the length unit\n"
+                 "  --chunk-rows n         rows per HDF5 chunk and per buffered write (default: 16384)\n"
+                 "  --deflate level        deflate compression level 0-9, 0 disables (default: 4)\n"
+                 "  --profile              write per-phase timings to <output>.profile.json and /profile\n"
+                 "  --world-transforms     write /occurrences with the world transform of every placed shape\n"
+                 "  --mesh                 write /mesh with the triangulation of every prototype shape\n"
+                 "  --mesh-deflection d    linear deflection of --mesh in model units (default: 0.1)\n"
+                 "  --mesh-angle a         angular deflection of --mesh in radians (default: 0.5)\n"
+                 "  --bvh                  write /bounds and a /bvh over the placed shapes (implies --world-transforms)\n"
+                 "  --shards n             write labels, properties and mesh to n shard files in parallel,\n"
+                 "                         joined by virtual datasets in the output file\n"
+                 "  --incremental          update an existing flat export, rewriting changed rows only;\n"
+                 "                         not with --mesh or --bvh, whose tables are always rebuilt\n"
+                 "  --cache-dir dir        reuse the output of an identical input and option set\n"
+                 "  --document-cache dir   keep transferred XDE documents (BinXCAF) and skip STEP parsing\n"
+                 "                         for inputs seen before, whatever the export options\n"
+                 "  --cache-max-mb n       evict least recently used entries of either cache above n MB\n"
+                 "  --progress s           print the phase, completion and rate of every file each s seconds\n"
+                 "  --deadline s           give up on a file that has not reached its write after s seconds\n";
+}
 
-void WriteLabelToHDF5(const TDF_Label& label, H5::Group& group) {
-    if (label.IsNull()) return;
+// Parse text as a whole decimal integer in [min, max].
+static bool ParseInteger(const char* text, long min, long max, long& value) {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtol(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0 && value >= min && value <= max;
+}
 
-    // Try to get the name attribute
-    Handle(TDataStd_Name) nameAttr;
-    if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
-         TCollection_ExtendedString extStr = nameAttr->Get();
-         TCollection_AsciiString asciStr(extStr);
-        const char* aName = asciStr.ToCString();
-        group.createAttribute("name", H5::StrType(H5::PredType::C_S1, H5T_VARIABLE), H5::DataSpace())
-             .write(H5::StrType(H5::PredType::C_S1, H5T_VARIABLE), aName);
+int main(int argc, char** argv) {
+    // WriteShards starts this executable again for every shard
+    if (argc > 1 && std::strcmp(argv[1], theShardWriterFlag) == 0) {
+        return RunShardWriter(argc - 2, argv + 2);
     }
 
-    // Recursively process child labels
-    for (TDF_ChildIterator it(label, Standard_True); it.More(); it.Next()) {
-        const TDF_Label& child = it.Value();
-        std::string childName = "label_" + std::to_string(child.Tag());
-        H5::Group childGroup = group.createGroup(childName);
-        WriteLabelToHDF5(child, childGroup);
+    ConvertOptions options;
+    std::string stepFile;
+    std::string hdf5File;
+    std::string batchSource;
+    std::string socketPath;
+    std::string spoolDir;
+    std::string outputDir;
+    unsigned jobs = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "flat") == 0) {
+                options.layout = LabelLayout::Flat;
+            } else if (std::strcmp(value, "groups") == 0) {
+                options.layout = LabelLayout::Groups;
+            } else {
+                std::cerr << "Unknown layout: " << value << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--no-properties") == 0) {
+            options.massProperties = false;
+        } else if (std::strcmp(argv[i], "--no-colors") == 0) {
+            options.colors = false;
+        } else if (std::strcmp(argv[i], "--probe") == 0) {
+            options.probe = true;
+        } else if (std::strcmp(argv[i], "--probe-scan") == 0) {
+            options.probe = true;
+            options.probeScan = true;
+        } else if (std::strcmp(argv[i], "--attributes-only") == 0) {
+            options.attributesOnly = true;
+        } else if (std::strcmp(argv[i], "--chunk-rows") == 0 && i + 1 < argc) {
+            options.storage.chunkRows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--deflate") == 0 && i + 1 < argc) {
+            long level = 0;
+            if (!ParseInteger(argv[++i], 0, 9, level)) {
+                std::cerr << "Invalid deflate level: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+            options.storage.deflateLevel = static_cast<int>(level);
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            options.profile = true;
+        } else if (std::strcmp(argv[i], "--world-transforms") == 0) {
+            options.worldTransforms = true;
+        } else if (std::strcmp(argv[i], "--bvh") == 0) {
+            options.bvh = true;
+            options.worldTransforms = true;
+        } else if (std::strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            // Every shard is a writer process of its own
+            long shards = 0;
+            if (!ParseInteger(argv[++i], 1, 1024, shards)) {
+                std::cerr << "Invalid shard count: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+            options.shards = static_cast<int>(shards);
+        } else if (std::strcmp(argv[i], "--mesh") == 0) {
+            options.mesh = true;
+        } else if (std::strcmp(argv[i], "--mesh-deflection") == 0 && i + 1 < argc) {
+            options.meshDeflection = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--mesh-angle") == 0 && i + 1 < argc) {
+            options.meshAngle = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--incremental") == 0) {
+            options.incremental = true;
+        } else if (std::strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            options.cacheDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--document-cache") == 0 && i + 1 < argc) {
+            options.documentCacheDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--cache-max-mb") == 0 && i + 1 < argc) {
+            options.cacheMaxBytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (std::strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            options.progressSeconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) {
+            options.deadlineSeconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchSource = argv[++i];
+        } else if (std::strcmp(argv[i], "--serve-socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--serve-spool") == 0 && i + 1 < argc) {
+            spoolDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            long count = 0;
+            if (!ParseInteger(argv[++i], 1, 4096, count)) {
+                std::cerr << "Invalid job count: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+            jobs = static_cast<unsigned>(count);
+        } else if (stepFile.empty()) {
+            stepFile = argv[i];
+        } else {
+            hdf5File = argv[i];
+        }
     }
-}
-#define Debug 1
 
-int main(int argc, char** argv) {
-    #if !Debug
-    if (argc < 3) {
-        std::cerr << "Usage: step2hdf5 input.step output.h5\n";
+    // Prototypes that change resize every later range of /mesh, and any moved
+    // box reshapes the BVH, so both are always rebuilt and cannot take the
+    // incremental path
+    if (options.incremental && (options.mesh || options.bvh)) {
+        std::cerr << "--incremental cannot be combined with --mesh or --bvh\n";
+        PrintUsage();
         return 1;
     }
-    std::string stepFile = argv[1];
-    std::string hdf5File = argv[2];
-    #else
-    std::string stepFile = "io1-ac-214.stp"; //argv[1];
-    std::string hdf5File = "io1-ac-214.h5"; //argv[2];
-    #endif
-
-
-    // Initialize the OCCT XDE application
-    Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
-    Handle(TDocStd_Document) doc;
-    app->NewDocument("MDTV-XCAF", doc);
 
-    // Read STEP file
-    STEPCAFControl_Reader reader;
-    reader.SetColorMode(true);
-    reader.SetNameMode(true);
-    reader.SetLayerMode(true);
+    if (!socketPath.empty()) {
+        return ServeSocket(socketPath, outputDir, options, jobs);
+    }
+    if (!spoolDir.empty()) {
+        return ServeSpool(spoolDir, outputDir, options, jobs);
+    }
 
-    IFSelect_ReturnStatus status = reader.ReadFile(stepFile.c_str());
-    if (status != IFSelect_RetDone) {
-        std::cerr << "Failed to read STEP file.\n";
-        return 1;
+    if (!batchSource.empty()) {
+        std::vector<std::string> stepFiles = CollectStepFiles(batchSource);
+        if (stepFiles.empty()) {
+            std::cerr << "No STEP files found in: " << batchSource << "\n";
+            return 1;
+        }
+        return RunBatch(stepFiles, outputDir, options, jobs) == 0 ? 0 : 1;
     }
 
-    if (!reader.Transfer(doc)) {
-        std::cerr << "Failed to transfer STEP to XDE document.\n";
+    if (stepFile.empty() || hdf5File.empty()) {
+        PrintUsage();
         return 1;
     }
 
-    // Get the root label
-    TDF_Label shapeLabel = XCAFDoc_DocumentTool::ShapesLabel(doc->Main());
-    // TDF_LabelSequence aRootLabels;
-    // Handle(XCAFDoc_ShapeTool) Assembly = XCAFDoc_DocumentTool::ShapesLabel(doc->Main());
-    // Assembly->GetFreeShapes(aRootLabels);
-    // TDF_Label shapeLabel = aRootLabels.First();
-
-    try {
-        H5::H5File file(hdf5File, H5F_ACC_TRUNC);
-        H5::Group rootGroup = file.createGroup("/properties");
-
-        // Start recursive export
-        WriteLabelToHDF5(shapeLabel, rootGroup);
-
-        std::cout << "STEP attributes written to: " << hdf5File << "\n";
-    } catch (H5::FileIException& e) {
-        std::cerr << "HDF5 File Error: " << e.getCDetailMsg() << "\n";
-        return 1;
-    } catch (H5::Exception& e) {
-        std::cerr << "HDF5 Error: " << e.getCDetailMsg() << "\n";
+    if (!ConvertStepFile(stepFile, hdf5File, options)) {
         return 1;
     }
-
+    std::cout << "STEP attributes written to: " << hdf5File << "\n";
     return 0;
 }
@@ -0,0 +1,315 @@
+// Writes a synthetic AP214 assembly for benchmarking the converter.
+//
+// The product structure follows io1-ac-214.stp: each part is a PRODUCT with
+// one PRODUCT_DEFINITION whose shape is a box B-rep, and each assembly is a
+// SHAPE_REPRESENTATION whose components are NEXT_ASSEMBLY_USAGE_OCCURRENCEs
+// placed by ITEM_DEFINED_TRANSFORMATIONs.
+//
+// Level 0 holds --parts unique boxes. Every level above holds assemblies of
+// --fanout components, and each node of the level below is instanced about
+// --reuse times, so reuse > 1 produces shared sub-assemblies and repeated
+// parts. The single top assembly covers every node of the level below it.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct GeneratorOptions {
+    int parts = 100;
+    int depth = 2;
+    int fanout = 10;
+    int reuse = 1;
+    int nameLength = 0; // pad names to this many characters, 0 keeps them short
+    std::string output = "synthetic.stp";
+};
+
+struct Node {
+    int pd = 0;   // PRODUCT_DEFINITION entity
+    int rep = 0;  // shape representation entity
+    int axis = 0; // origin placement inside rep
+};
+
+class StepWriter {
+public:
+    explicit StepWriter(std::ostream& out) : myOut(out) {}
+
+    // Emit "#n=<body>;" and return n.
+    int Add(const std::string& body) {
+        myOut << '#' << ++myLast << '=' << body << ";\n";
+        return myLast;
+    }
+
+    int Count() const { return myLast; }
+
+private:
+    std::ostream& myOut;
+    int myLast = 0;
+};
+
+std::string Ref(int id) { return "#" + std::to_string(id); }
+
+std::string Real(double value) {
+    std::ostringstream out;
+    out.precision(15);
+    out << value;
+    std::string str = out.str();
+    if (str.find_first_of(".eE") == std::string::npos) str += ".";
+    return str;
+}
+
+std::string Triple(double x, double y, double z) {
+    return "(" + Real(x) + "," + Real(y) + "," + Real(z) + ")";
+}
+
+std::string List(const std::vector<int>& ids) {
+    std::string str = "(";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i) str += ",";
+        str += Ref(ids[i]);
+    }
+    return str + ")";
+}
+
+std::string PaddedName(const std::string& base, int length) {
+    std::string name = base;
+    for (int i = 0; static_cast<int>(name.size()) < length; ++i) {
+        name += static_cast<char>('A' + (i % 26));
+    }
+    return name;
+}
+
+class SyntheticAssembly {
+public:
+    SyntheticAssembly(StepWriter& writer, const GeneratorOptions& options)
+        : myWriter(writer), myOptions(options) {}
+
+    void Write() {
+        WriteContexts();
+
+        std::vector<Node> level;
+        for (int i = 0; i < myOptions.parts; ++i) {
+            level.push_back(WritePart(i));
+        }
+        for (int depth = 1; depth <= myOptions.depth; ++depth) {
+            const bool top = depth == myOptions.depth;
+            const int below = static_cast<int>(level.size());
+            int count = top ? 1 : std::max(1, (below * myOptions.reuse + myOptions.fanout - 1) / myOptions.fanout);
+            int fanout = top ? std::max(myOptions.fanout, below) : myOptions.fanout;
+
+            std::vector<Node> next;
+            for (int j = 0; j < count; ++j) {
+                std::vector<Node> components;
+                for (int c = 0; c < fanout; ++c) {
+                    components.push_back(level[static_cast<size_t>((j * fanout + c) % below)]);
+                }
+                next.push_back(WriteAssembly(depth, j, components));
+            }
+            level.swap(next);
+        }
+    }
+
+private:
+    void WriteContexts() {
+        StepWriter& w = myWriter;
+        int radian = w.Add("(NAMED_UNIT(*)PLANE_ANGLE_UNIT()SI_UNIT($,.RADIAN.))");
+        int exponents = w.Add("DIMENSIONAL_EXPONENTS(0.0,0.0,0.0,0.0,0.0,0.0,0.0)");
+        int angle = w.Add("PLANE_ANGLE_MEASURE_WITH_UNIT(PLANE_ANGLE_MEASURE(0.017453292500000)," + Ref(radian) + ")");
+        int degree = w.Add("(CONVERSION_BASED_UNIT('DEGREE'," + Ref(angle) + ")NAMED_UNIT(" + Ref(exponents) + ")PLANE_ANGLE_UNIT())");
+        int steradian = w.Add("(NAMED_UNIT(*)SI_UNIT($,.STERADIAN.)SOLID_ANGLE_UNIT())");
+        int mm = w.Add("(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.MILLI.,.METRE.))");
+        int uncertainty = w.Add("UNCERTAINTY_MEASURE_WITH_UNIT(LENGTH_MEASURE(0.000001000000000)," + Ref(mm) + ",'DISTANCE_ACCURACY_VALUE','')");
+        myGeomContext = w.Add("(GEOMETRIC_REPRESENTATION_CONTEXT(3)GLOBAL_UNCERTAINTY_ASSIGNED_CONTEXT((" + Ref(uncertainty) +
+                              "))GLOBAL_UNIT_ASSIGNED_CONTEXT((" + Ref(degree) + "," + Ref(steradian) + "," + Ref(mm) +
+                              "))REPRESENTATION_CONTEXT('None','None'))");
+        int application = w.Add("APPLICATION_CONTEXT('automotive design')");
+        w.Add("APPLICATION_PROTOCOL_DEFINITION('DRAFT_INTERNATIONAL_STANDARD','automotive_design',1998," + Ref(application) + ")");
+        myProductContext = w.Add("PRODUCT_CONTEXT('3D Mechanical Parts'," + Ref(application) + ",'mechanical')");
+        myDefinitionContext = w.Add("PRODUCT_DEFINITION_CONTEXT('part definition'," + Ref(application) + ",'design')");
+        myZ = w.Add("DIRECTION('NONE',(0.0,0.0,1.0))");
+        myX = w.Add("DIRECTION('NONE',(1.0,0.0,0.0))");
+    }
+
+    int WriteAxis(double x, double y, double z) {
+        int point = myWriter.Add("CARTESIAN_POINT('NONE'," + Triple(x, y, z) + ")");
+        return myWriter.Add("AXIS2_PLACEMENT_3D('NONE'," + Ref(point) + "," + Ref(myZ) + "," + Ref(myX) + ")");
+    }
+
+    int WriteProduct(const std::string& name) {
+        StepWriter& w = myWriter;
+        int product = w.Add("PRODUCT('" + name + "','" + name + "','',(" + Ref(myProductContext) + "))");
+        int formation = w.Add("PRODUCT_DEFINITION_FORMATION_WITH_SPECIFIED_SOURCE('None',''," + Ref(product) + ",.BOUGHT.)");
+        return w.Add("PRODUCT_DEFINITION('None',''," + Ref(formation) + "," + Ref(myDefinitionContext) + ")");
+    }
+
+    void WriteShapeDefinition(int pd, int rep) {
+        int pds = myWriter.Add("PRODUCT_DEFINITION_SHAPE('',''," + Ref(pd) + ")");
+        myWriter.Add("SHAPE_DEFINITION_REPRESENTATION(" + Ref(pds) + "," + Ref(rep) + ")");
+    }
+
+    // Closed box B-rep: 8 vertices, 12 line edges, 6 planar faces, outward normals.
+    int WriteBox(double dx, double dy, double dz) {
+        StepWriter& w = myWriter;
+        std::array<int, 8> points{};
+        std::array<int, 8> vertices{};
+        for (int v = 0; v < 8; ++v) {
+            points[v] = w.Add("CARTESIAN_POINT(''," + Triple((v & 1) * dx, ((v >> 1) & 1) * dy, ((v >> 2) & 1) * dz) + ")");
+            vertices[v] = w.Add("VERTEX_POINT(''," + Ref(points[v]) + ")");
+        }
+
+        auto coord = [&](int v, int axis) { return ((v >> axis) & 1) * (axis == 0 ? dx : axis == 1 ? dy : dz); };
+        int edges[8][8] = {};
+        auto edge = [&](int a, int b) {
+            const int lo = std::min(a, b), hi = std::max(a, b);
+            if (!edges[lo][hi]) {
+                double d[3], length = 0.0;
+                for (int axis = 0; axis < 3; ++axis) {
+                    d[axis] = coord(hi, axis) - coord(lo, axis);
+                    length += d[axis] * d[axis];
+                }
+                length = std::sqrt(length);
+                int dir = w.Add("DIRECTION(''," + Triple(d[0] / length, d[1] / length, d[2] / length) + ")");
+                int vec = w.Add("VECTOR(''," + Ref(dir) + "," + Real(length) + ")");
+                int line = w.Add("LINE(''," + Ref(points[lo]) + "," + Ref(vec) + ")");
+                edges[lo][hi] = w.Add("EDGE_CURVE(''," + Ref(vertices[lo]) + "," + Ref(vertices[hi]) + "," + Ref(line) + ",.T.)");
+            }
+            return w.Add("ORIENTED_EDGE('',*,*," + Ref(edges[lo][hi]) + "," + (a < b ? ".T." : ".F.") + ")");
+        };
+
+        // Counter-clockwise seen from outside, with the outward normal
+        static const int faceLoops[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        static const double normals[6][3] = {{0, 0, -1}, {0, 0, 1}, {0, -1, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}};
+        std::vector<int> faces;
+        for (int f = 0; f < 6; ++f) {
+            const int* loop = faceLoops[f];
+            std::vector<int> oriented;
+            for (int i = 0; i < 4; ++i) {
+                oriented.push_back(edge(loop[i], loop[(i + 1) % 4]));
+            }
+            int edgeLoop = w.Add("EDGE_LOOP(''," + List(oriented) + ")");
+            int bound = w.Add("FACE_OUTER_BOUND(''," + Ref(edgeLoop) + ",.T.)");
+
+            const double* n = normals[f];
+            const double ref[3] = {n[0] == 0.0 ? 1.0 : 0.0, n[0] == 0.0 ? 0.0 : 1.0, 0.0};
+            int normal = w.Add("DIRECTION(''," + Triple(n[0], n[1], n[2]) + ")");
+            int refDir = w.Add("DIRECTION(''," + Triple(ref[0], ref[1], ref[2]) + ")");
+            int axis = w.Add("AXIS2_PLACEMENT_3D(''," + Ref(points[loop[0]]) + "," + Ref(normal) + "," + Ref(refDir) + ")");
+            int plane = w.Add("PLANE(''," + Ref(axis) + ")");
+            faces.push_back(w.Add("ADVANCED_FACE(''," + List({bound}) + "," + Ref(plane) + ",.T.)"));
+        }
+        int shell = w.Add("CLOSED_SHELL(''," + List(faces) + ")");
+        return w.Add("MANIFOLD_SOLID_BREP(''," + Ref(shell) + ")");
+    }
+
+    Node WritePart(int index) {
+        const std::string name = PaddedName("PART" + std::to_string(index + 1), myOptions.nameLength);
+        Node node;
+        node.pd = WriteProduct(name);
+        node.axis = WriteAxis(0.0, 0.0, 0.0);
+        int solid = WriteBox(10.0 + index % 7, 5.0 + index % 3, 2.0 + index % 5);
+        node.rep = myWriter.Add("ADVANCED_BREP_SHAPE_REPRESENTATION('" + name + "'," + List({node.axis, solid}) + "," +
+                                Ref(myGeomContext) + ")");
+        WriteShapeDefinition(node.pd, node.rep);
+        return node;
+    }
+
+    Node WriteAssembly(int depth, int index, const std::vector<Node>& components) {
+        StepWriter& w = myWriter;
+        const std::string name = PaddedName("ASM" + std::to_string(depth) + "_" + std::to_string(index + 1),
+                                            myOptions.nameLength);
+        Node node;
+        node.pd = WriteProduct(name);
+        node.axis = WriteAxis(0.0, 0.0, 0.0);
+
+        std::vector<int> placements{node.axis};
+        for (size_t c = 0; c < components.size(); ++c) {
+            placements.push_back(WriteAxis(30.0 * static_cast<double>(c), 20.0 * depth, 0.0));
+        }
+        node.rep = w.Add("SHAPE_REPRESENTATION('" + name + "'," + List(placements) + "," + Ref(myGeomContext) + ")");
+        WriteShapeDefinition(node.pd, node.rep);
+
+        for (size_t c = 0; c < components.size(); ++c) {
+            const Node& child = components[c];
+            const std::string instance = PaddedName(name + "_I" + std::to_string(c + 1), myOptions.nameLength);
+            int nauo = w.Add("NEXT_ASSEMBLY_USAGE_OCCURRENCE('NAUO" + std::to_string(++myNauoCount) + "','" + instance +
+                             "',''," + Ref(node.pd) + "," + Ref(child.pd) + ",$)");
+            int pds = w.Add("PRODUCT_DEFINITION_SHAPE('',''," + Ref(nauo) + ")");
+            int transform = w.Add("ITEM_DEFINED_TRANSFORMATION('',''," + Ref(child.axis) + "," +
+                                  Ref(placements[c + 1]) + ")");
+            int relation = w.Add("(REPRESENTATION_RELATIONSHIP('',''," + Ref(child.rep) + "," +
+                                 Ref(node.rep) + ")REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION(" + Ref(transform) +
+                                 ")SHAPE_REPRESENTATION_RELATIONSHIP())");
+            w.Add("CONTEXT_DEPENDENT_SHAPE_REPRESENTATION(" + Ref(relation) + "," + Ref(pds) + ")");
+        }
+        return node;
+    }
+
+    StepWriter& myWriter;
+    const GeneratorOptions& myOptions;
+    int myGeomContext = 0;
+    int myProductContext = 0;
+    int myDefinitionContext = 0;
+    int myZ = 0;
+    int myX = 0;
+    int myNauoCount = 0;
+};
+
+void PrintUsage() {
+    std::cerr << "Usage: GenerateSyntheticStep [--parts n] [--depth n] [--fanout n] [--reuse n]\n"
+                 "                             [--name-length n] output.stp\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    bool hasOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        auto intArg = [&](int& value) { value = std::max(1, std::atoi(argv[++i])); };
+        if (std::strcmp(argv[i], "--parts") == 0 && i + 1 < argc) {
+            intArg(options.parts);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            intArg(options.depth);
+        } else if (std::strcmp(argv[i], "--fanout") == 0 && i + 1 < argc) {
+            intArg(options.fanout);
+        } else if (std::strcmp(argv[i], "--reuse") == 0 && i + 1 < argc) {
+            intArg(options.reuse);
+        } else if (std::strcmp(argv[i], "--name-length") == 0 && i + 1 < argc) {
+            options.nameLength = std::max(0, std::atoi(argv[++i]));
+        } else if (argv[i][0] != '-') {
+            options.output = argv[i];
+            hasOutput = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (!hasOutput) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::ofstream out(options.output);
+    if (!out) {
+        std::cerr << "Cannot write: " << options.output << "\n";
+        return 1;
+    }
+    out << "ISO-10303-21;\nHEADER;\nFILE_DESCRIPTION((''),'2;1');\n"
+        << "FILE_NAME('" << options.output << "','2000-01-01T00:00:00',(''),(''),'GenerateSyntheticStep','HelloOccStepToH5','');\n"
+        << "FILE_SCHEMA(('AUTOMOTIVE_DESIGN { 1 2 10303 214 0 1 1 1 }'));\nENDSEC;\nDATA;\n";
+
+    StepWriter writer(out);
+    SyntheticAssembly(writer, options).Write();
+    out << "ENDSEC;\nEND-ISO-10303-21;\n";
+
+    std::cout << options.output << ": " << writer.Count() << " entities\n";
+    return out ? 0 : 1;
+}
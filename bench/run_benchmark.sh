@@ -0,0 +1,42 @@
+#!/usr/bin/sh
+# Generate synthetic assemblies and report converter throughput.
+# Usage: run_benchmark.sh <converter> <generator> <work_dir> [converter options...]
+if [ "$#" -lt 3 ]; then
+  echo "Usage: run_benchmark.sh <converter> <generator> <work_dir> [converter options...]"
+  exit 1
+fi
+
+converter=$1
+generator=$2
+work_dir=$3
+shift 3
+
+mkdir -p $work_dir
+
+# name  parts depth fanout reuse name-length
+cases="small:50:2:10:1:8
+medium:1000:3:20:2:16
+large:5000:3:40:4:32
+deep:200:8:4:2:16"
+
+printf "%-8s %10s %10s %10s %12s %10s\n" case labels "STEP MB" seconds labels/s MB/s
+for c in $cases; do
+  name=$(echo $c | cut -d: -f1)
+  step_file=$work_dir/$name.stp
+  h5_file=$work_dir/$name.h5
+  if [ ! -f $step_file ]; then
+    $generator --parts $(echo $c | cut -d: -f2) --depth $(echo $c | cut -d: -f3) \
+      --fanout $(echo $c | cut -d: -f4) --reuse $(echo $c | cut -d: -f5) \
+      --name-length $(echo $c | cut -d: -f6) $step_file > /dev/null || exit 1
+  fi
+
+  start=$(date +%s.%N)
+  $converter --profile "$@" $step_file $h5_file > /dev/null || exit 1
+  end=$(date +%s.%N)
+
+  labels=$(sed -n 's/.*"labels": \([0-9]*\).*/\1/p' $h5_file.profile.json)
+  bytes=$(wc -c < $step_file)
+  awk -v n=$name -v l=${labels:-0} -v b=$bytes -v s=$start -v e=$end 'BEGIN {
+    t = e - s; mb = b / 1048576;
+    printf "%-8s %10d %10.2f %10.3f %12.0f %10.2f\n", n, l, mb, t, l / t, mb / t }'
+done
@@ -1,11 +1,20 @@
 #!/usr/bin/sh
 OCC_SDK=/opt/occt/7.8.1/
 HDF5_SDK=/opt/hdf5/1.14
-gcc -std=c++20 WriteStepAttributeHdf5.cpp -o step2hdf5 \
-  -std=c++20 \
+gcc -std=c++20 WriteStepAttributeHdf5.cpp StepLabelTable.cpp StringHeap.cpp \
+  StepToH5Converter.cpp BatchConverter.cpp MassProperties.cpp \
+  StepProductStructure.cpp ConversionProfile.cpp IncrementalExport.cpp \
+  ConversionCache.cpp LabelGroupWriter.cpp InstanceTable.cpp \
+  OccurrenceTable.cpp MeshExport.cpp ColorTable.cpp \
+  MembershipTable.cpp NameIndex.cpp SpatialIndex.cpp \
+  StepScanner.cpp ShardedExport.cpp \
+  ConversionDaemon.cpp ConversionProgress.cpp \
+  StepProbe.cpp -o step2hdf5 \
+  -std=c++20 -pthread \
   -I$OCC_SDK/include/opencascade \
   -I$HDF5_SDK/include \
-  -L$OCC_SDK/lib -lstdc++ -lTKDESTEP -lTKXCAF -lTKCAF -lTKernel -lTKXSBase -lTKShHealing \
+  -L$OCC_SDK/lib -lstdc++ -lTKDESTEP -lTKBinXCAF -lTKBin -lTKBinL -lTKXCAF -lTKCAF -lTKernel -lTKXSBase -lTKShHealing \
+  -lTKMesh -lTKTopAlgo -lTKGeomAlgo -lTKBRep -lTKMath \
   -L$HDF5_SDK/lib -lhdf5_cpp -lhdf5
 
 
@@ -7,6 +7,14 @@ elif [ -z $1 ];then
   exit
 fi
 
+export LD_LIBRARY_PATH=/opt/occt/7.8.1/lib:/opt/hdf5/1.14/lib
+
+# a directory or a .txt file list is converted in one batch invocation
+if [ -d $1 ] || [ "${1##*.}" = "txt" ];then
+  ./build/HelloOccStepToH5 --batch $1
+  exit
+fi
+
 in_stepfile=$1
 out_h5file=""
 
@@ -22,6 +30,4 @@ fi
 echo "step file is "$in_stepfile
 echo "hd5 file is "$out_h5file
 
-export LD_LIBRARY_PATH=/opt/occt/7.8.1/lib:/opt/hdf5/1.14/lib
-./build/HelloOccStepToH5 $in_stepfile $out_h5file
 ./build/HelloOccStepToH5 $in_stepfile $out_h5file
\ No newline at end of file